@@ -1,19 +1,125 @@
 #include <mpi.h>
+#include <omp.h>
 #include <iostream>
 #include <vector>
 #include <numeric> 
 #include <cstdlib> 
 #include <ctime> 
 #include <cmath> 
+#include <cstdint>
+#include <string>
+#include <algorithm>
+
+#include "philox.hpp"
+
+// Counts and displacements of a vector_size-element vector split over processes ranks
+void block_partition(int vector_size, int processes, std::vector<int>& counts, std::vector<int>& displs) {
+    counts.assign(processes, vector_size / processes);
+    displs.assign(processes, 0);
+    for (int i = 0; i < vector_size % processes; ++i) {
+        counts[i] += 1;
+    }
+    for (int i = 1; i < processes; ++i) {
+        displs[i] = displs[i - 1] + counts[i - 1];
+    }
+}
+
+// Philox streams of the two input vectors
+const uint64_t STREAM_A = 0;
+const uint64_t STREAM_B = 1;
+
+// Local dot product with OpenMP threads + SIMD lanes and a 64-bit accumulator
+long long dot_product(const int* a, const int* b, int n, int threads) {
+    long long sum = 0;
+
+    #pragma omp parallel for simd reduction(+:sum) num_threads(threads) schedule(static)
+    for (int i = 0; i < n; ++i) {
+        sum += static_cast<long long>(a[i]) * b[i];
+    }
+
+    return sum;
+}
 
 int main(int argc, char* argv[]) {
-    MPI_Init(&argc, &argv);
+    // Only the master thread of each rank calls MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+    if (provided < MPI_THREAD_FUNNELED && rank == 0) {
+        std::cerr << "Warning: MPI library does not provide MPI_THREAD_FUNNELED." << std::endl;
+    }
+
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+
+    // "scatter": rank 0 generates vec_a / vec_b and scatters them
+    // "local":   every rank generates only its own blocks, nothing is scattered
+    std::string mode = "scatter";
+
+    // "mpi":    one single-threaded rank per core (launch e.g. mpirun -np <cores>)
+    // "hybrid": few ranks with --threads OpenMP threads each
+    //           (launch e.g. mpirun -np <sockets> --map-by ppr:1:socket --bind-to socket)
+    std::string layout = "mpi";
+    int threads = omp_get_max_threads();
+
     std::vector<int> vector_sizes = { 2000, 4000, 6000, 8000, 10000 };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--mode") mode = argv[i + 1];
+        else if (arg == "--seed") seed = std::stoull(argv[i + 1]);
+        else if (arg == "--layout") layout = argv[i + 1];
+        else if (arg == "--threads") threads = std::stoi(argv[i + 1]);
+        else if (arg == "--sizes") {
+            vector_sizes.clear();
+            std::string list = argv[i + 1];
+            size_t pos = 0;
+            while (pos < list.size()) {
+                size_t next = list.find(',', pos);
+                if (next == std::string::npos) next = list.size();
+                vector_sizes.push_back(std::stoi(list.substr(pos, next - pos)));
+                pos = next + 1;
+            }
+        }
+    }
+
+    if (layout != "mpi" && layout != "hybrid") {
+        if (rank == 0) {
+            std::cerr << "Error: --layout must be 'mpi' or 'hybrid'.\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (layout == "mpi") {
+        threads = 1;
+    }
+
+    if (mode != "scatter" && mode != "local") {
+        if (rank == 0) {
+            std::cerr << "Error: --mode must be 'scatter' or 'local'.\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    MPI_Bcast(&seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    // Ranks sharing a node with this one
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    int ranks_per_node;
+    MPI_Comm_size(node_comm, &ranks_per_node);
+    MPI_Comm_free(&node_comm);
+
+    if (rank == 0) {
+        std::cout << "Data generation mode: " << mode << ", seed: " << seed << std::endl;
+        std::cout << "Layout: " << layout << ", ranks per node: " << ranks_per_node
+            << ", threads per rank: " << threads << std::endl;
+    }
+
     std::vector<int> process_counts = { 1, 2, 3, 4, 5, 6, 7, 8 };
 
     for (int vector_size : vector_sizes) {
@@ -24,36 +130,56 @@ int main(int argc, char* argv[]) {
         }
 
         std::vector<int> vec_a, vec_b;
-        if (rank == 0) {
+        if (rank == 0 && mode == "scatter") {
             vec_a.resize(vector_size);
             vec_b.resize(vector_size);
 
-
-            std::srand(std::time(nullptr));
-            for (int i = 0; i < vector_size; ++i) {
-                vec_a[i] = std::rand() % 10; 
-                vec_b[i] = std::rand() % 10;
-            }
+            philox::fill_uniform_int(vec_a.data(), 0, vector_size, seed, STREAM_A, 0, 9);
+            philox::fill_uniform_int(vec_b.data(), 0, vector_size, seed, STREAM_B, 0, 9);
         }
 
      
         for (int processes : process_counts) {
+            if (processes > size) {
+                if (rank == 0) {
+                    std::cout << "Skipping " << processes << " processes: only " << size << " started" << std::endl;
+                }
+                continue;
+            }
+
             if (rank == 0) {
                 std::cout << "Running with " << processes << " processes..." << std::endl;
             }
 
-            int local_size = std::ceil(static_cast<double>(vector_size) / processes);
+            // Only the first `processes` ranks take part in this sweep point
+            MPI_Comm comm;
+            MPI_Comm_split(MPI_COMM_WORLD, rank < processes ? 0 : MPI_UNDEFINED, rank, &comm);
+            if (comm == MPI_COMM_NULL) {
+                MPI_Barrier(MPI_COMM_WORLD);
+                continue;
+            }
+
+            std::vector<int> counts, displs;
+            block_partition(vector_size, processes, counts, displs);
+
+            int local_size = counts[rank];
             std::vector<int> local_a(local_size), local_b(local_size);
 
-            MPI_Scatter(vec_a.data(), local_size, MPI_INT, local_a.data(), local_size, MPI_INT, 0, MPI_COMM_WORLD);
-            MPI_Scatter(vec_b.data(), local_size, MPI_INT, local_b.data(), local_size, MPI_INT, 0, MPI_COMM_WORLD);
+            if (mode == "local") {
+                philox::fill_uniform_int(local_a.data(), displs[rank], local_size, seed, STREAM_A, 0, 9);
+                philox::fill_uniform_int(local_b.data(), displs[rank], local_size, seed, STREAM_B, 0, 9);
+            }
+            else {
+                MPI_Scatterv(vec_a.data(), counts.data(), displs.data(), MPI_INT, local_a.data(), local_size, MPI_INT, 0, comm);
+                MPI_Scatterv(vec_b.data(), counts.data(), displs.data(), MPI_INT, local_b.data(), local_size, MPI_INT, 0, comm);
+            }
 
             double start_time = MPI_Wtime();
 
-            int local_dot_product = std::inner_product(local_a.begin(), local_a.end(), local_b.begin(), 0);
+            long long local_dot_product = dot_product(local_a.data(), local_b.data(), local_size, threads);
 
-            int global_dot_product = 0;
-            MPI_Reduce(&local_dot_product, &global_dot_product, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+            long long global_dot_product = 0;
+            MPI_Allreduce(&local_dot_product, &global_dot_product, 1, MPI_LONG_LONG, MPI_SUM, comm);
 
             double end_time = MPI_Wtime();
 
@@ -65,13 +191,15 @@ int main(int argc, char* argv[]) {
 
             if (rank == 0) {
                 std::cout << "Time taken for " << vector_size << " elements with " << processes << " processes: "
-                    << time_taken << " seconds" << std::endl;
+                    << time_taken << " seconds (" << processes * threads << " cores)" << std::endl;
+                std::cout << "Dot product: " << global_dot_product << std::endl;
 
                 double speedup = (time_single_process > 0) ? time_single_process / time_taken : 1.0;
                 std::cout << "Speedup for " << processes << " processes: " << speedup << std::endl;
             }
 
             //    
+            MPI_Comm_free(&comm);
             MPI_Barrier(MPI_COMM_WORLD);
         }
 
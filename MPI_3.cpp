@@ -1,7 +1,292 @@
 #include <mpi.h>
 #include <iostream>
 #include <vector>
-#include <chrono>
+#include <string>
+#include <algorithm>
+
+// Point-to-point suite between ranks 0 and 1, in the style of the OSU micro-benchmarks:
+//   latency: blocking ping-pong, one-way time per iteration with percentiles
+//   bw:      unidirectional bandwidth with a window of MPI_Isend/MPI_Irecv
+//   bibw:    bidirectional bandwidth, both ranks send a window at once
+//   modes:   median latency of every transport mode side by side. Two-sided
+//            modes (Send, persistent, Ssend, Rsend) report half a round trip;
+//            one-sided modes report one MPI_Put / MPI_Get plus its synchronization.
+
+const int TAG = 0;
+const int ACK_TAG = 1;
+
+struct Options {
+    int max_size = 4 * 1024 * 1024;   // Largest message in bytes
+    int iterations = 1000;            // Timed iterations for messages up to 8 KB
+    int large_iterations = 100;       // Timed iterations for larger messages
+    int warmup = 100;                 // Untimed iterations before every size
+    int window = 64;                  // Messages in flight in the bandwidth tests
+};
+
+// Message sizes 0, 1, 2, 4, ... max_size
+std::vector<int> message_sizes(int max_size) {
+    std::vector<int> sizes = { 0 };
+    for (int n = 1; n <= max_size; n *= 2) {
+        sizes.push_back(n);
+    }
+    return sizes;
+}
+
+int iterations_for(int n, const Options& options) {
+    return n > 8192 ? options.large_iterations : options.iterations;
+}
+
+// Window for size n, capped so the receive slices of one window stay within 64 MB
+const size_t MAX_WINDOW_BYTES = 64 * 1024 * 1024;
+
+int window_for(int n, const Options& options) {
+    size_t cap = MAX_WINDOW_BYTES / std::max(n, 1);
+    return static_cast<int>(std::max<size_t>(1, std::min<size_t>(options.window, cap)));
+}
+
+double percentile(const std::vector<double>& sorted, double q) {
+    size_t index = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// One-way latency samples (half of every round trip), measured on rank 0
+std::vector<double> ping_pong(int rank, int n, int warmup, int iterations, std::vector<char>& send_buffer, std::vector<char>& recv_buffer) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    for (int i = 0; i < warmup + iterations; ++i) {
+        if (rank == 0) {
+            double start_time = MPI_Wtime();
+            MPI_Send(send_buffer.data(), n, MPI_CHAR, 1, TAG, MPI_COMM_WORLD);
+            MPI_Recv(recv_buffer.data(), n, MPI_CHAR, 1, TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            double round_trip = MPI_Wtime() - start_time;
+            if (i >= warmup) {
+                samples.push_back(round_trip / 2);
+            }
+        }
+        else if (rank == 1) {
+            MPI_Recv(recv_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(send_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD);
+        }
+    }
+
+    return samples;
+}
+
+enum class TwoSided { Send, Persistent, Ssend, Rsend };
+
+// Ping-pong like ping_pong() with a choice of send mode; returns the median one-way time
+double two_sided_latency(int rank, int n, int warmup, int iterations, TwoSided mode,
+    std::vector<char>& send_buffer, std::vector<char>& recv_buffer) {
+    if (rank > 1) return 0.0;
+
+    int peer = 1 - rank;
+    int total = warmup + iterations;
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    MPI_Request requests[2];
+    if (mode == TwoSided::Persistent) {
+        MPI_Recv_init(recv_buffer.data(), n, MPI_CHAR, peer, TAG, MPI_COMM_WORLD, &requests[0]);
+        MPI_Send_init(send_buffer.data(), n, MPI_CHAR, peer, TAG, MPI_COMM_WORLD, &requests[1]);
+    }
+
+    // A ready send needs the matching receive to be posted already, so rank 1
+    // posts the receive of the next ping before it sends its reply
+    MPI_Request ping = MPI_REQUEST_NULL;
+    if (mode == TwoSided::Rsend) {
+        if (rank == 1) {
+            MPI_Irecv(recv_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD, &ping);
+        }
+        MPI_Sendrecv(nullptr, 0, MPI_CHAR, peer, ACK_TAG, nullptr, 0, MPI_CHAR, peer, ACK_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    }
+
+    for (int i = 0; i < total; ++i) {
+        double start_time = MPI_Wtime();
+
+        if (mode == TwoSided::Persistent) {
+            if (rank == 0) {
+                MPI_Startall(2, requests);
+                MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+            }
+            else {
+                MPI_Start(&requests[0]);
+                MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+                MPI_Start(&requests[1]);
+                MPI_Wait(&requests[1], MPI_STATUS_IGNORE);
+            }
+        }
+        else if (mode == TwoSided::Rsend) {
+            if (rank == 0) {
+                MPI_Request reply;
+                MPI_Irecv(recv_buffer.data(), n, MPI_CHAR, 1, TAG, MPI_COMM_WORLD, &reply);
+                MPI_Rsend(send_buffer.data(), n, MPI_CHAR, 1, TAG, MPI_COMM_WORLD);
+                MPI_Wait(&reply, MPI_STATUS_IGNORE);
+            }
+            else {
+                MPI_Wait(&ping, MPI_STATUS_IGNORE);
+                if (i + 1 < total) {
+                    MPI_Irecv(recv_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD, &ping);
+                }
+                MPI_Rsend(send_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD);
+            }
+        }
+        else {
+            auto send = mode == TwoSided::Ssend ? MPI_Ssend : MPI_Send;
+            if (rank == 0) {
+                send(send_buffer.data(), n, MPI_CHAR, 1, TAG, MPI_COMM_WORLD);
+                MPI_Recv(recv_buffer.data(), n, MPI_CHAR, 1, TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            }
+            else {
+                MPI_Recv(recv_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                send(send_buffer.data(), n, MPI_CHAR, 0, TAG, MPI_COMM_WORLD);
+            }
+        }
+
+        if (i >= warmup) {
+            samples.push_back((MPI_Wtime() - start_time) / 2);
+        }
+    }
+
+    if (mode == TwoSided::Persistent) {
+        MPI_Request_free(&requests[0]);
+        MPI_Request_free(&requests[1]);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return percentile(samples, 0.5);
+}
+
+enum class RmaOp { Put, Get };
+enum class RmaSync { Fence, Pscw, LockAll };
+
+// Median time of one MPI_Put / MPI_Get from rank 0 to rank 1 of pair_comm including
+// its synchronization. Both ranks of pair_comm call this with the same arguments.
+double rma_latency(MPI_Comm pair_comm, MPI_Win win, char* origin, int n, int warmup, int iterations,
+    RmaOp op, RmaSync sync) {
+    int rank;
+    MPI_Comm_rank(pair_comm, &rank);
+
+    // Access / exposure groups for PSCW: each rank only talks to the other one
+    MPI_Group pair_group, peer_group;
+    MPI_Comm_group(pair_comm, &pair_group);
+    int peer = 1 - rank;
+    MPI_Group_incl(pair_group, 1, &peer, &peer_group);
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    auto transfer = [&]() {
+        if (op == RmaOp::Put) MPI_Put(origin, n, MPI_CHAR, 1, 0, n, MPI_CHAR, win);
+        else MPI_Get(origin, n, MPI_CHAR, 1, 0, n, MPI_CHAR, win);
+    };
+
+    if (sync == RmaSync::LockAll && rank == 0) {
+        MPI_Win_lock_all(0, win);
+    }
+
+    for (int i = 0; i < warmup + iterations; ++i) {
+        double start_time = MPI_Wtime();
+
+        if (sync == RmaSync::Fence) {
+            MPI_Win_fence(0, win);
+            if (rank == 0) transfer();
+            MPI_Win_fence(0, win);
+        }
+        else if (sync == RmaSync::Pscw) {
+            if (rank == 0) {
+                MPI_Win_start(peer_group, 0, win);
+                transfer();
+                MPI_Win_complete(win);
+            }
+            else {
+                MPI_Win_post(peer_group, 0, win);
+                MPI_Win_wait(win);
+            }
+        }
+        else if (rank == 0) {
+            transfer();
+            MPI_Win_flush(1, win);
+        }
+
+        if (i >= warmup) {
+            samples.push_back(MPI_Wtime() - start_time);
+        }
+    }
+
+    if (sync == RmaSync::LockAll && rank == 0) {
+        MPI_Win_unlock_all(win);
+    }
+    MPI_Barrier(pair_comm);
+
+    MPI_Group_free(&peer_group);
+    MPI_Group_free(&pair_group);
+
+    std::sort(samples.begin(), samples.end());
+    return percentile(samples, 0.5);
+}
+
+// Seconds for `iterations` windows of messages from rank 0 to rank 1 (or both ways)
+double windowed_transfer(int rank, int n, int warmup, int iterations, int window, bool bidirectional,
+    std::vector<char>& send_buffer, std::vector<char>& recv_buffer) {
+    std::vector<MPI_Request> requests(2 * window);
+    double start_time = 0.0;
+
+    for (int i = 0; i < warmup + iterations; ++i) {
+        if (i == warmup) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            start_time = MPI_Wtime();
+        }
+
+        int count = 0;
+        if (rank == 0 || rank == 1) {
+            int peer = 1 - rank;
+            bool sends = rank == 0 || bidirectional;
+            bool receives = rank == 1 || bidirectional;
+
+            // Every message of the window lands in its own slice of the receive buffer
+            for (int w = 0; w < window && receives; ++w) {
+                MPI_Irecv(recv_buffer.data() + static_cast<size_t>(w) * n, n, MPI_CHAR, peer, TAG, MPI_COMM_WORLD, &requests[count++]);
+            }
+            for (int w = 0; w < window && sends; ++w) {
+                MPI_Isend(send_buffer.data(), n, MPI_CHAR, peer, TAG, MPI_COMM_WORLD, &requests[count++]);
+            }
+            MPI_Waitall(count, requests.data(), MPI_STATUSES_IGNORE);
+
+            // The receiver acknowledges the window so the sender cannot run ahead
+            if (!bidirectional) {
+                if (rank == 0) {
+                    MPI_Recv(nullptr, 0, MPI_CHAR, 1, ACK_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                }
+                else {
+                    MPI_Send(nullptr, 0, MPI_CHAR, 0, ACK_TAG, MPI_COMM_WORLD);
+                }
+            }
+        }
+    }
+
+    return MPI_Wtime() - start_time;
+}
+
+// The eager-to-rendezvous switch shows up as a latency step: in the
+// bandwidth-bound regime the latency increment doubles with the size, so the
+// size where the increment grows the most beyond that is reported.
+int protocol_switch(const std::vector<int>& sizes, const std::vector<double>& latency) {
+    int best = -1;
+    double best_ratio = 1.5;
+    for (size_t i = 2; i + 1 < sizes.size(); ++i) {
+        if (sizes[i] < 256) continue;
+        double previous_step = latency[i] - latency[i - 1];
+        double step = latency[i + 1] - latency[i];
+        if (previous_step <= 0) continue;
+        double ratio = step / (2 * previous_step);
+        if (ratio > best_ratio) {
+            best_ratio = ratio;
+            best = static_cast<int>(i + 1);
+        }
+    }
+    return best;
+}
 
 int main(int argc, char* argv[]) {
     MPI_Init(&argc, &argv);
@@ -18,57 +303,139 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::vector<int> message_sizes = { 1024, 2048, 4096, 8192, 16384 }; // Message sizes in bytes
-    std::vector<int> iterations_list = { 100, 500, 1000, 2000 }; // Number of iterations
+    Options options;
+    std::string test = "all";   // latency, bw, bibw, modes or all
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--test") test = argv[i + 1];
+        else if (arg == "--max-size") options.max_size = std::stoi(argv[i + 1]);
+        else if (arg == "--iterations") options.iterations = std::stoi(argv[i + 1]);
+        else if (arg == "--large-iterations") options.large_iterations = std::stoi(argv[i + 1]);
+        else if (arg == "--warmup") options.warmup = std::stoi(argv[i + 1]);
+        else if (arg == "--window") options.window = std::stoi(argv[i + 1]);
+    }
 
-    std::vector<char> send_buffer, recv_buffer;
+    std::vector<int> sizes = message_sizes(options.max_size);
 
-    for (int n : message_sizes) {
-        for (int iterations : iterations_list) {
+    std::vector<char> send_buffer(options.max_size, 'x');
+    std::vector<char> recv_buffer(std::max<size_t>(options.max_size, std::min(MAX_WINDOW_BYTES, static_cast<size_t>(options.max_size) * options.window)));
 
-            //Initialize buffers for the current message size
-            send_buffer.resize(n, 'x');
-            recv_buffer.resize(n);
+    if (test == "all" || test == "latency") {
+        if (rank == 0) {
+            std::cout << "# Latency (one-way, us)\n";
+            std::cout << "Size (bytes) | Iterations | Min | Median | Mean | P90 | P99\n";
+        }
 
+        std::vector<double> median_latency;
+        for (int n : sizes) {
             MPI_Barrier(MPI_COMM_WORLD);
+            std::vector<double> samples = ping_pong(rank, n, options.warmup, iterations_for(n, options), send_buffer, recv_buffer);
 
-            auto start_time = std::chrono::high_resolution_clock::now();
+            if (rank == 0) {
+                double mean = 0.0;
+                for (double s : samples) mean += s;
+                mean /= samples.size();
+                std::sort(samples.begin(), samples.end());
+                median_latency.push_back(percentile(samples, 0.5));
 
-            for (int i = 0; i < iterations; ++i) {
-                if (rank == 0) {
-                    // Process 0 sends a message to process 1 and receives a response
-                    MPI_Send(send_buffer.data(), n, MPI_CHAR, 1, 0, MPI_COMM_WORLD);
-                    MPI_Recv(recv_buffer.data(), n, MPI_CHAR, 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                }
-                else if (rank == 1) {
-                    // Process 1 receives a message from process 0 and sends a reply
-                    MPI_Recv(recv_buffer.data(), n, MPI_CHAR, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                    MPI_Send(send_buffer.data(), n, MPI_CHAR, 0, 0, MPI_COMM_WORLD);
-                }
+                std::cout << n << " | " << samples.size()
+                    << " | " << samples.front() * 1e6
+                    << " | " << percentile(samples, 0.5) * 1e6
+                    << " | " << mean * 1e6
+                    << " | " << percentile(samples, 0.9) * 1e6
+                    << " | " << percentile(samples, 0.99) * 1e6 << "\n";
             }
+        }
 
-            MPI_Barrier(MPI_COMM_WORLD);
+        if (rank == 0) {
+            int index = protocol_switch(sizes, median_latency);
+            if (index > 0) {
+                std::cout << "Likely eager-to-rendezvous switch between " << sizes[index - 1]
+                    << " and " << sizes[index] << " bytes\n";
+            }
+            else {
+                std::cout << "No eager-to-rendezvous switch detected\n";
+            }
+            std::cout << "-------------------------------------\n";
+        }
+    }
+
+    for (bool bidirectional : { false, true }) {
+        if (test != "all" && test != (bidirectional ? "bibw" : "bw")) continue;
+
+        if (rank == 0) {
+            std::cout << (bidirectional ? "# Bidirectional" : "# Unidirectional") << " bandwidth, window " << options.window << "\n";
+            std::cout << "Size (bytes) | Window | Iterations | Time (s) | Bandwidth (MB/s) | Messages/s\n";
+        }
+
+        for (int n : sizes) {
+            if (n == 0) continue;
+
+            int iterations = iterations_for(n, options);
+            int window = window_for(n, options);
+            double elapsed_time = windowed_transfer(rank, n, options.warmup / 10, iterations, window,
+                bidirectional, send_buffer, recv_buffer);
+
+            if (rank == 0) {
+                double messages = static_cast<double>(iterations) * window * (bidirectional ? 2 : 1);
+                std::cout << n << " | " << window << " | " << iterations
+                    << " | " << elapsed_time
+                    << " | " << messages * n / elapsed_time / 1e6
+                    << " | " << messages / elapsed_time << "\n";
+            }
+        }
 
-            auto end_time = std::chrono::high_resolution_clock::now();
-            double elapsed_time = std::chrono::duration<double>(end_time - start_time).count();
+        if (rank == 0) {
+            std::cout << "-------------------------------------\n";
+        }
+    }
+
+    if (test == "all" || test == "modes") {
+        // One-sided tests run on a communicator of ranks 0 and 1 only
+        MPI_Comm pair_comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < 2 ? 0 : MPI_UNDEFINED, rank, &pair_comm);
+
+        if (pair_comm != MPI_COMM_NULL) {
+            char* window_memory;
+            MPI_Win win;
+            MPI_Win_allocate(std::max(options.max_size, 1), 1, MPI_INFO_NULL, pair_comm, &window_memory, &win);
 
             if (rank == 0) {
-                std::cout << "Message size: " << n << " bytes\n";
-                std::cout << "Iterations: " << iterations << "\n";
-                std::cout << "Total time: " << elapsed_time << " seconds\n";
-                std::cout << "Average time per message pair: " << (elapsed_time / iterations) << " seconds\n";
+                std::cout << "# Transport modes (median latency, us)\n";
+                std::cout << "Size (bytes) | Send | Persistent | Ssend | Rsend"
+                    << " | Put fence | Put PSCW | Put lock_all | Get fence | Get PSCW | Get lock_all\n";
+            }
 
-                double bandwidth = (n * iterations * 2) / elapsed_time / 1e6; 
-                std::cout << "Data transfer speed: " << bandwidth << " MB/s\n";
+            for (int n : sizes) {
+                int iterations = iterations_for(n, options);
+                std::vector<double> latency;
 
-                double speed = static_cast<double>(n) / elapsed_time; 
-                std::cout << "Speed (bytes per second): " << speed << " bytes/sec\n";
+                for (TwoSided mode : { TwoSided::Send, TwoSided::Persistent, TwoSided::Ssend, TwoSided::Rsend }) {
+                    latency.push_back(two_sided_latency(rank, n, options.warmup, iterations, mode, send_buffer, recv_buffer));
+                }
+                for (RmaOp op : { RmaOp::Put, RmaOp::Get }) {
+                    char* origin = op == RmaOp::Put ? send_buffer.data() : recv_buffer.data();
+                    for (RmaSync sync : { RmaSync::Fence, RmaSync::Pscw, RmaSync::LockAll }) {
+                        latency.push_back(rma_latency(pair_comm, win, origin, n, options.warmup, iterations, op, sync));
+                    }
+                }
 
-                std::cout << "-------------------------------------\n";
+                if (rank == 0) {
+                    std::cout << n;
+                    for (double t : latency) {
+                        std::cout << " | " << t * 1e6;
+                    }
+                    std::cout << "\n";
+                }
             }
 
+            if (rank == 0) {
+                std::cout << "-------------------------------------\n";
+            }
 
-            MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Win_free(&win);
+            MPI_Comm_free(&pair_comm);
         }
     }
 
@@ -5,10 +5,54 @@
 #include <ctime>
 #include <cmath>
 #include <numeric>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <chrono>
 
-void initializeMatrix(std::vector<double>& matrix, int rows, int cols) {
-    for (int i = 0; i < rows * cols; ++i) {
-        matrix[i] = rand() % 10; // Random values between 0 and 9
+#include "gemm.hpp"
+#include "philox.hpp"
+
+// Distributed C = A * B for N x N matrices.
+//   rowslab:  every rank gets a row slab of A and a full copy of B (the original version)
+//   pipeline: like rowslab, but B is broadcast in column panels that overlap with the multiply
+//   shared:   like rowslab, but B is held once per node in an MPI-3 shared-memory window
+//   summa:    2D block distribution on a pr x pc grid, row / column broadcasts of panels
+//   cannon:   2D block distribution on a q x q grid, cyclic shifts of A and B blocks
+// The 2D algorithms keep O(N^2 / p) matrix memory per rank.
+
+// Philox streams of the two input matrices
+const uint64_t STREAM_A = 0;
+const uint64_t STREAM_B = 1;
+
+struct Options {
+    std::string kernel = "blocked";     // local multiply: "blocked" (gemm.hpp) or "naive"
+    std::string algorithm = "rowslab";  // "rowslab", "pipeline", "shared", "summa" or "cannon"
+    int panel = 256;                    // Width of the B column panels of the pipeline
+    int threads = 1;                    // OpenMP threads of the local multiply in every rank
+    uint64_t seed = 0;
+};
+
+struct Result {
+    bool ran = true;        // false if the algorithm cannot use this process count
+    double totalTime = 0;   // distribution + multiply + collection, slowest rank
+    double computeTime = 0; // local multiplies only, slowest rank
+    double checksum = 0;    // sum of all elements of C
+    double expected = 0;    // the same sum computed from the column sums of A and row sums of B
+    double nodeBytes = 0;   // matrix storage of all ranks of a node, largest node
+};
+
+// Fills the rows x cols block starting at (row0, col0) of the N x N matrix of the given stream.
+// Elements are values 0..9 that depend only on their position, so every distribution sees the same matrix.
+void generateBlock(double* block, int ld, int row0, int rows, int col0, int cols, int N, uint64_t seed, uint64_t stream) {
+    std::vector<int> values(cols);
+    for (int i = 0; i < rows; ++i) {
+        uint64_t offset = static_cast<uint64_t>(row0 + i) * N + col0;
+        philox::fill_uniform_int(values.data(), offset, cols, seed, stream, 0, 9);
+        std::copy(values.begin(), values.end(), block + static_cast<size_t>(i) * ld);
     }
 }
 
@@ -21,104 +65,676 @@ void printMatrix(const std::vector<double>& matrix, int rows, int cols) {
     }
 }
 
+// Sizes of n items split over parts; the first n % parts get one more
+std::vector<int> splitCounts(int n, int parts) {
+    std::vector<int> counts(parts, n / parts);
+    for (int i = 0; i < n % parts; ++i) {
+        counts[i] += 1;
+    }
+    return counts;
+}
+
+std::vector<int> splitOffsets(const std::vector<int>& counts) {
+    std::vector<int> offsets(counts.size(), 0);
+    for (size_t i = 1; i < counts.size(); ++i) {
+        offsets[i] = offsets[i - 1] + counts[i - 1];
+    }
+    return offsets;
+}
+
+// Index of the part that contains item k
+int ownerOf(int k, const std::vector<int>& offsets) {
+    return static_cast<int>(std::upper_bound(offsets.begin(), offsets.end(), k) - offsets.begin()) - 1;
+}
+
+void localMultiply(int M, int N, int K, const double* A, int lda, const double* B, int ldb, double* C, int ldc, const Options& options) {
+    if (options.kernel == "naive") {
+        gemm::dgemm_naive(M, N, K, A, lda, B, ldb, C, ldc);
+    }
+    else {
+        gemm::dgemm(M, N, K, A, lda, B, ldb, C, ldc, options.threads);
+    }
+}
+
+// Column sums of an A block and row sums of a B block, accumulated into N-long vectors.
+// sum(C) = sum_k colSumA[k] * rowSumB[k] gives the expected checksum without the full matrices.
+void addColumnSums(const double* block, int rows, int cols, int col0, std::vector<double>& sums) {
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            sums[col0 + j] += block[static_cast<size_t>(i) * cols + j];
+        }
+    }
+}
+
+void addRowSums(const double* block, int rows, int cols, int row0, std::vector<double>& sums) {
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            sums[row0 + i] += block[static_cast<size_t>(i) * cols + j];
+        }
+    }
+}
+
+// Reduces the per-rank partial sums, times and matrix storage (in doubles) of a run into the final Result
+void finishResult(Result& result, std::vector<double>& colSumA, std::vector<double>& rowSumB,
+    const std::vector<double>& C, double localTotal, double localCompute, size_t localElements, MPI_Comm comm) {
+    int N = static_cast<int>(colSumA.size());
+    MPI_Allreduce(MPI_IN_PLACE, colSumA.data(), N, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(MPI_IN_PLACE, rowSumB.data(), N, MPI_DOUBLE, MPI_SUM, comm);
+
+    result.expected = 0;
+    for (int k = 0; k < N; ++k) {
+        result.expected += colSumA[k] * rowSumB[k];
+    }
+
+    double localSum = std::accumulate(C.begin(), C.end(), 0.0);
+    MPI_Allreduce(&localSum, &result.checksum, 1, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(&localTotal, &result.totalTime, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(&localCompute, &result.computeTime, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm nodeComm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    double localBytes = static_cast<double>(localElements) * sizeof(double), nodeBytes;
+    MPI_Allreduce(&localBytes, &nodeBytes, 1, MPI_DOUBLE, MPI_SUM, nodeComm);
+    MPI_Allreduce(&nodeBytes, &result.nodeBytes, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Comm_free(&nodeComm);
+}
+
+// 1D row-slab distribution: rank 0 sends a slab of A to every rank and broadcasts all of B
+Result runRowSlab(int N, MPI_Comm comm, const Options& options) {
+    int rank, processes;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &processes);
+
+    std::vector<int> rowsPerProc = splitCounts(N, processes);
+    std::vector<int> rowOffsets = splitOffsets(rowsPerProc);
+
+    std::vector<double> A, B(N * N), C(rowsPerProc[rank] * N, 0);
+    std::vector<double> localA(rowsPerProc[rank] * N);
+    std::vector<double> colSumA(N, 0.0), rowSumB(N, 0.0);
+
+    if (rank == 0) {
+        A.resize(N * N);
+        generateBlock(A.data(), N, 0, N, 0, N, N, options.seed, STREAM_A);
+        generateBlock(B.data(), N, 0, N, 0, N, N, options.seed, STREAM_B);
+        addColumnSums(A.data(), N, N, 0, colSumA);
+        addRowSums(B.data(), N, N, 0, rowSumB);
+    }
+
+    size_t collectedElements = 0;
+
+    MPI_Barrier(comm);
+    double startTime = MPI_Wtime();
+
+    if (rank == 0) {
+        for (int i = 1; i < processes; ++i) {
+            MPI_Send(A.data() + rowOffsets[i] * N, rowsPerProc[i] * N, MPI_DOUBLE, i, 0, comm);
+        }
+        std::copy(A.data(), A.data() + rowsPerProc[0] * N, localA.data());
+    }
+    else {
+        MPI_Recv(localA.data(), rowsPerProc[rank] * N, MPI_DOUBLE, 0, 0, comm, MPI_STATUS_IGNORE);
+    }
+
+    MPI_Bcast(B.data(), N * N, MPI_DOUBLE, 0, comm);
+
+    double computeStart = MPI_Wtime();
+    localMultiply(rowsPerProc[rank], N, N, localA.data(), N, B.data(), N, C.data(), N, options);
+    double computeTime = MPI_Wtime() - computeStart;
+
+    if (rank == 0) {
+        std::vector<double> fullC(N * N, 0);
+        collectedElements = fullC.size();
+        std::copy(C.begin(), C.end(), fullC.begin());
+
+        for (int i = 1; i < processes; ++i) {
+            MPI_Recv(fullC.data() + rowOffsets[i] * N, rowsPerProc[i] * N, MPI_DOUBLE, i, 0, comm, MPI_STATUS_IGNORE);
+        }
+    }
+    else {
+        MPI_Send(C.data(), rowsPerProc[rank] * N, MPI_DOUBLE, 0, 0, comm);
+    }
+    double totalTime = MPI_Wtime() - startTime;
+
+    Result result;
+    finishResult(result, colSumA, rowSumB, C, totalTime, computeTime,
+        A.size() + B.size() + localA.size() + C.size() + collectedElements, comm);
+    return result;
+}
+
+// Pipelined row-slab distribution: A is scattered and C gathered with precomputed displacements,
+// and B goes out in column panels. Panel p + 1 is broadcast with MPI_Ibcast while panel p is
+// multiplied, so only the first panel and the final gather are exposed
+Result runPipelined(int N, MPI_Comm comm, const Options& options) {
+    int rank, processes;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &processes);
+
+    std::vector<int> rowsPerProc = splitCounts(N, processes);
+    std::vector<int> rowOffsets = splitOffsets(rowsPerProc);
+    std::vector<int> sendCounts(processes), displacements(processes);
+    for (int i = 0; i < processes; ++i) {
+        sendCounts[i] = rowsPerProc[i] * N;
+        displacements[i] = rowOffsets[i] * N;
+    }
+
+    int myRows = rowsPerProc[rank];
+    std::vector<double> A, B, fullC;
+    std::vector<double> localA(static_cast<size_t>(myRows) * N), C(static_cast<size_t>(myRows) * N, 0.0);
+    std::vector<double> colSumA(N, 0.0), rowSumB(N, 0.0);
+
+    if (rank == 0) {
+        A.resize(static_cast<size_t>(N) * N);
+        B.resize(static_cast<size_t>(N) * N);
+        fullC.resize(static_cast<size_t>(N) * N);
+        generateBlock(A.data(), N, 0, N, 0, N, N, options.seed, STREAM_A);
+        generateBlock(B.data(), N, 0, N, 0, N, N, options.seed, STREAM_B);
+        addColumnSums(A.data(), N, N, 0, colSumA);
+        addRowSums(B.data(), N, N, 0, rowSumB);
+    }
+
+    int width = std::max(1, std::min(options.panel, N));
+    int panels = (N + width - 1) / width;
+
+    // Two panel buffers: one being multiplied, one being broadcast
+    std::vector<double> panelB[2] = { std::vector<double>(static_cast<size_t>(N) * width),
+                                      std::vector<double>(static_cast<size_t>(N) * width) };
+    auto panelWidth = [&](int p) { return std::min(width, N - p * width); };
+    auto packPanel = [&](int p, double* out) {
+        int w = panelWidth(p);
+        for (int k = 0; k < N; ++k) {
+            const double* src = B.data() + static_cast<size_t>(k) * N + p * width;
+            std::copy(src, src + w, out + static_cast<size_t>(k) * w);
+        }
+    };
+
+    MPI_Barrier(comm);
+    double startTime = MPI_Wtime();
+    double computeTime = 0.0;
+
+    MPI_Scatterv(A.data(), sendCounts.data(), displacements.data(), MPI_DOUBLE,
+        localA.data(), myRows * N, MPI_DOUBLE, 0, comm);
+
+    MPI_Request request;
+    if (rank == 0) {
+        packPanel(0, panelB[0].data());
+    }
+    MPI_Ibcast(panelB[0].data(), N * panelWidth(0), MPI_DOUBLE, 0, comm, &request);
+
+    for (int p = 0; p < panels; ++p) {
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+
+        if (p + 1 < panels) {
+            double* next = panelB[(p + 1) % 2].data();
+            if (rank == 0) {
+                packPanel(p + 1, next);
+            }
+            MPI_Ibcast(next, N * panelWidth(p + 1), MPI_DOUBLE, 0, comm, &request);
+        }
+
+        int w = panelWidth(p);
+        double computeStart = MPI_Wtime();
+        localMultiply(myRows, w, N, localA.data(), N, panelB[p % 2].data(), w, C.data() + p * width, N, options);
+        computeTime += MPI_Wtime() - computeStart;
+    }
+
+    MPI_Igatherv(C.data(), myRows * N, MPI_DOUBLE,
+        fullC.data(), sendCounts.data(), displacements.data(), MPI_DOUBLE, 0, comm, &request);
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    double totalTime = MPI_Wtime() - startTime;
+
+    Result result;
+    finishResult(result, colSumA, rowSumB, C, totalTime, computeTime,
+        A.size() + B.size() + fullC.size() + localA.size() + C.size() + panelB[0].size() + panelB[1].size(), comm);
+    return result;
+}
+
+// Node-shared B: the ranks of a node map one copy of B from an MPI_Win_allocate_shared window.
+// Only the node leaders take part in the broadcast of B, the other ranks read the leader's copy
+Result runSharedB(int N, MPI_Comm comm, const Options& options) {
+    int rank, processes;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &processes);
+
+    // Ranks ordered by rank inside each node, so rank 0 of comm is the leader of its node
+    // and rank 0 of the leader communicator
+    MPI_Comm nodeComm, leaderComm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    int nodeRank;
+    MPI_Comm_rank(nodeComm, &nodeRank);
+    MPI_Comm_split(comm, nodeRank == 0 ? 0 : MPI_UNDEFINED, rank, &leaderComm);
+
+    MPI_Aint windowBytes = nodeRank == 0 ? static_cast<MPI_Aint>(N) * N * sizeof(double) : 0;
+    double* B;
+    MPI_Win window;
+    MPI_Win_allocate_shared(windowBytes, sizeof(double), MPI_INFO_NULL, nodeComm, &B, &window);
+    if (nodeRank != 0) {
+        MPI_Aint leaderBytes;
+        int displacementUnit;
+        MPI_Win_shared_query(window, 0, &leaderBytes, &displacementUnit, &B);
+    }
+
+    std::vector<int> rowsPerProc = splitCounts(N, processes);
+    std::vector<int> rowOffsets = splitOffsets(rowsPerProc);
+    std::vector<int> sendCounts(processes), displacements(processes);
+    for (int i = 0; i < processes; ++i) {
+        sendCounts[i] = rowsPerProc[i] * N;
+        displacements[i] = rowOffsets[i] * N;
+    }
+
+    int myRows = rowsPerProc[rank];
+    std::vector<double> A, fullC;
+    std::vector<double> localA(static_cast<size_t>(myRows) * N), C(static_cast<size_t>(myRows) * N, 0.0);
+    std::vector<double> colSumA(N, 0.0), rowSumB(N, 0.0);
+
+    // Passive target epoch for the whole run; MPI_Win_sync + barrier order the leader's writes before the reads
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+
+    if (rank == 0) {
+        A.resize(static_cast<size_t>(N) * N);
+        fullC.resize(static_cast<size_t>(N) * N);
+        generateBlock(A.data(), N, 0, N, 0, N, N, options.seed, STREAM_A);
+        generateBlock(B, N, 0, N, 0, N, N, options.seed, STREAM_B);
+        addColumnSums(A.data(), N, N, 0, colSumA);
+        addRowSums(B, N, N, 0, rowSumB);
+    }
+
+    MPI_Barrier(comm);
+    double startTime = MPI_Wtime();
+
+    MPI_Scatterv(A.data(), sendCounts.data(), displacements.data(), MPI_DOUBLE,
+        localA.data(), myRows * N, MPI_DOUBLE, 0, comm);
+
+    if (leaderComm != MPI_COMM_NULL) {
+        MPI_Bcast(B, N * N, MPI_DOUBLE, 0, leaderComm);
+    }
+    MPI_Win_sync(window);
+    MPI_Barrier(nodeComm);
+    MPI_Win_sync(window);
+
+    double computeStart = MPI_Wtime();
+    localMultiply(myRows, N, N, localA.data(), N, B, N, C.data(), N, options);
+    double computeTime = MPI_Wtime() - computeStart;
+
+    MPI_Gatherv(C.data(), myRows * N, MPI_DOUBLE,
+        fullC.data(), sendCounts.data(), displacements.data(), MPI_DOUBLE, 0, comm);
+    double totalTime = MPI_Wtime() - startTime;
+
+    Result result;
+    finishResult(result, colSumA, rowSumB, C, totalTime, computeTime,
+        A.size() + fullC.size() + localA.size() + C.size() + windowBytes / sizeof(double), comm);
+
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+    if (leaderComm != MPI_COMM_NULL) {
+        MPI_Comm_free(&leaderComm);
+    }
+    MPI_Comm_free(&nodeComm);
+    return result;
+}
+
+// 2D process grid with row and column communicators
+struct Grid {
+    MPI_Comm cart, rowComm, colComm;
+    int dims[2];
+    int coords[2];
+
+    explicit Grid(MPI_Comm comm, bool square) {
+        int processes;
+        MPI_Comm_size(comm, &processes);
+        dims[0] = dims[1] = 0;
+        if (square) {
+            dims[0] = dims[1] = static_cast<int>(std::lround(std::sqrt(processes)));
+        }
+        MPI_Dims_create(processes, 2, dims);
+
+        int periods[2] = { 1, 1 };
+        MPI_Cart_create(comm, 2, dims, periods, 0, &cart);
+
+        int rank;
+        MPI_Comm_rank(cart, &rank);
+        MPI_Cart_coords(cart, rank, 2, coords);
+
+        int keepCols[2] = { 0, 1 };   // ranks of one grid row, ordered by column
+        int keepRows[2] = { 1, 0 };   // ranks of one grid column, ordered by row
+        MPI_Cart_sub(cart, keepCols, &rowComm);
+        MPI_Cart_sub(cart, keepRows, &colComm);
+    }
+
+    ~Grid() {
+        MPI_Comm_free(&rowComm);
+        MPI_Comm_free(&colComm);
+        MPI_Comm_free(&cart);
+    }
+};
+
+// SUMMA: for every panel of the k dimension, the owners broadcast their A columns
+// along the grid row and their B rows along the grid column, then everyone multiplies
+Result runSumma(int N, MPI_Comm comm, const Options& options) {
+    Grid grid(comm, false);
+    int myRow = grid.coords[0], myCol = grid.coords[1];
+
+    std::vector<int> rowCounts = splitCounts(N, grid.dims[0]), rowOffsets = splitOffsets(rowCounts);
+    std::vector<int> colCounts = splitCounts(N, grid.dims[1]), colOffsets = splitOffsets(colCounts);
+    int myRows = rowCounts[myRow], myCols = colCounts[myCol];
+
+    // A(i, j), B(i, j) and C(i, j) all cover rows rowOffsets[i] and columns colOffsets[j]
+    std::vector<double> A(static_cast<size_t>(myRows) * myCols), B(A.size()), C(A.size(), 0.0);
+    generateBlock(A.data(), myCols, rowOffsets[myRow], myRows, colOffsets[myCol], myCols, N, options.seed, STREAM_A);
+    generateBlock(B.data(), myCols, rowOffsets[myRow], myRows, colOffsets[myCol], myCols, N, options.seed, STREAM_B);
+
+    std::vector<double> colSumA(N, 0.0), rowSumB(N, 0.0);
+    addColumnSums(A.data(), myRows, myCols, colOffsets[myCol], colSumA);
+    addRowSums(B.data(), myRows, myCols, rowOffsets[myRow], rowSumB);
+
+    // k is split by columns for A and by rows for B; panels never cross a boundary of either
+    const int maxPanel = 256;
+    std::vector<double> panelA(static_cast<size_t>(myRows) * maxPanel), panelB(static_cast<size_t>(maxPanel) * myCols);
+
+    MPI_Barrier(comm);
+    double startTime = MPI_Wtime();
+    double computeTime = 0.0;
+
+    for (int k0 = 0; k0 < N;) {
+        int ownerCol = ownerOf(k0, colOffsets);
+        int ownerRow = ownerOf(k0, rowOffsets);
+        int k1 = std::min({ N, k0 + maxPanel,
+            colOffsets[ownerCol] + colCounts[ownerCol], rowOffsets[ownerRow] + rowCounts[ownerRow] });
+        int width = k1 - k0;
+
+        if (myCol == ownerCol) {
+            for (int i = 0; i < myRows; ++i) {
+                const double* src = A.data() + static_cast<size_t>(i) * myCols + (k0 - colOffsets[myCol]);
+                std::copy(src, src + width, panelA.data() + static_cast<size_t>(i) * width);
+            }
+        }
+        if (myRow == ownerRow) {
+            const double* src = B.data() + static_cast<size_t>(k0 - rowOffsets[myRow]) * myCols;
+            std::copy(src, src + static_cast<size_t>(width) * myCols, panelB.data());
+        }
+
+        MPI_Bcast(panelA.data(), myRows * width, MPI_DOUBLE, ownerCol, grid.rowComm);
+        MPI_Bcast(panelB.data(), width * myCols, MPI_DOUBLE, ownerRow, grid.colComm);
+
+        double computeStart = MPI_Wtime();
+        localMultiply(myRows, myCols, width, panelA.data(), width, panelB.data(), myCols, C.data(), myCols, options);
+        computeTime += MPI_Wtime() - computeStart;
+
+        k0 = k1;
+    }
+
+    double totalTime = MPI_Wtime() - startTime;
+
+    Result result;
+    finishResult(result, colSumA, rowSumB, C, totalTime, computeTime,
+        A.size() + B.size() + C.size() + panelA.size() + panelB.size(), comm);
+    return result;
+}
+
+// Cannon: after an initial skew, q multiply-and-shift steps move A blocks left
+// and B blocks up around the torus. Needs a square q x q grid.
+Result runCannon(int N, MPI_Comm comm, const Options& options) {
+    int processes;
+    MPI_Comm_size(comm, &processes);
+    int q = static_cast<int>(std::lround(std::sqrt(processes)));
+    if (q * q != processes) {
+        Result skipped;
+        skipped.ran = false;
+        return skipped;
+    }
+
+    Grid grid(comm, true);
+    int i = grid.coords[0], j = grid.coords[1];
+
+    std::vector<int> counts = splitCounts(N, q), offsets = splitOffsets(counts);
+    int myRows = counts[i], myCols = counts[j];
+    int maxCount = counts[0];
+
+    // A block (i, k) is counts[i] x counts[k], B block (k, j) is counts[k] x counts[j]
+    std::vector<double> A(static_cast<size_t>(myRows) * maxCount), B(static_cast<size_t>(maxCount) * myCols);
+    std::vector<double> recvA(A.size()), recvB(B.size());
+    std::vector<double> C(static_cast<size_t>(myRows) * myCols, 0.0);
+
+    generateBlock(A.data(), counts[j], offsets[i], myRows, offsets[j], counts[j], N, options.seed, STREAM_A);
+    generateBlock(B.data(), myCols, offsets[i], counts[i], offsets[j], myCols, N, options.seed, STREAM_B);
+
+    std::vector<double> colSumA(N, 0.0), rowSumB(N, 0.0);
+    addColumnSums(A.data(), myRows, counts[j], offsets[j], colSumA);
+    addRowSums(B.data(), counts[i], myCols, offsets[i], rowSumB);
+
+    MPI_Barrier(comm);
+    double startTime = MPI_Wtime();
+    double computeTime = 0.0;
+
+    // Block k of A / B currently held; shifting by `shift` moves it to the neighbour that needs it
+    int kA = j, kB = i;
+    auto shiftA = [&](int shift) {
+        int source, dest;
+        MPI_Cart_shift(grid.cart, 1, -shift, &source, &dest);
+        int next = ((kA + shift) % q + q) % q;
+        MPI_Sendrecv(A.data(), myRows * counts[kA], MPI_DOUBLE, dest, 0,
+            recvA.data(), myRows * counts[next], MPI_DOUBLE, source, 0, grid.cart, MPI_STATUS_IGNORE);
+        A.swap(recvA);
+        kA = next;
+    };
+    auto shiftB = [&](int shift) {
+        int source, dest;
+        MPI_Cart_shift(grid.cart, 0, -shift, &source, &dest);
+        int next = ((kB + shift) % q + q) % q;
+        MPI_Sendrecv(B.data(), counts[kB] * myCols, MPI_DOUBLE, dest, 1,
+            recvB.data(), counts[next] * myCols, MPI_DOUBLE, source, 1, grid.cart, MPI_STATUS_IGNORE);
+        B.swap(recvB);
+        kB = next;
+    };
+
+    // Initial skew: row i of A moves i steps left, column j of B moves j steps up
+    if (i % q != 0) shiftA(i);
+    if (j % q != 0) shiftB(j);
+
+    for (int step = 0; step < q; ++step) {
+        double computeStart = MPI_Wtime();
+        localMultiply(myRows, myCols, counts[kA], A.data(), counts[kA], B.data(), myCols, C.data(), myCols, options);
+        computeTime += MPI_Wtime() - computeStart;
+
+        if (step + 1 < q) {
+            shiftA(1);
+            shiftB(1);
+        }
+    }
+
+    double totalTime = MPI_Wtime() - startTime;
+
+    Result result;
+    finishResult(result, colSumA, rowSumB, C, totalTime, computeTime,
+        A.size() + B.size() + recvA.size() + recvB.size() + C.size(), comm);
+    return result;
+}
+
+// One point of the sweep: `processes` ranks with `threads` OpenMP threads each
+struct Layout {
+    int processes;
+    int threads;
+};
+
+// Parses "64x1,16x4,8x8,2x32"
+std::vector<Layout> parseLayouts(const std::string& text) {
+    std::vector<Layout> layouts;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t x = item.find('x');
+        if (x == std::string::npos) {
+            layouts.push_back({ std::stoi(item), 1 });
+        }
+        else {
+            layouts.push_back({ std::stoi(item.substr(0, x)), std::stoi(item.substr(x + 1)) });
+        }
+    }
+    return layouts;
+}
+
+// Barrier that sleeps between polls, so ranks left out of a layout do not spin on cores its threads use
+void idleBarrier(MPI_Comm comm) {
+    MPI_Request request;
+    MPI_Ibarrier(comm, &request);
+    int done = 0;
+    while (!done) {
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+        if (!done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+struct Row {
+    Layout layout;
+    int N;
+    Result result;
+};
+
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    // Only the master thread of each rank calls MPI; the threads of the local multiply do not
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    std::vector<int> matrix_sizes = { 16, 32, 64, 128, 256, 512, 1024, 2048 }; 
+    if (provided < MPI_THREAD_FUNNELED && rank == 0) {
+        std::cerr << "Warning: MPI library does not provide MPI_THREAD_FUNNELED." << std::endl;
+    }
+
+    std::vector<int> matrix_sizes = { 16, 32, 64, 128, 256, 512, 1024, 2048 };
     std::vector<int> process_counts = { 1, 2, 4, 8, 16, 32, 64 };
 
-   
-    for (int processes : process_counts) {
+    // --layouts RxT,... replaces the process sweep by ranks x threads points, e.g. for one 64-core node
+    //   OMP_PLACES=cores mpirun -np 64 ./MPI_4 --layouts 64x1,16x4,8x8,2x32
+    // Ranks 0..R-1 take part in an R x T point and should be spread T cores apart
+    // (e.g. --map-by ppr:R:node:pe=T) when one launch per layout is used.
+    std::string layoutText;
+
+    Options options;
+    options.seed = static_cast<uint64_t>(std::time(nullptr));
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--kernel") options.kernel = argv[i + 1];
+        else if (arg == "--algorithm") options.algorithm = argv[i + 1];
+        else if (arg == "--panel") options.panel = std::stoi(argv[i + 1]);
+        else if (arg == "--seed") options.seed = std::stoull(argv[i + 1]);
+        else if (arg == "--threads") options.threads = std::stoi(argv[i + 1]);
+        else if (arg == "--layouts") layoutText = argv[i + 1];
+    }
+    MPI_Bcast(&options.seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    if (options.algorithm != "rowslab" && options.algorithm != "pipeline" && options.algorithm != "shared"
+        && options.algorithm != "summa" && options.algorithm != "cannon") {
         if (rank == 0) {
-            std::cout << "Running with " << processes << " processes..." << std::endl;
+            std::cerr << "Error: --algorithm must be 'rowslab', 'pipeline', 'shared', 'summa' or 'cannon'.\n";
         }
+        MPI_Finalize();
+        return 1;
+    }
 
-       
-        for (int N : matrix_sizes) {
-            if (rank == 0) {
-                std::cout << "Matrix size: " << N << " x " << N << ", Number of processes: " << processes << std::endl;
-            }
-
-            
-            int rowsPerProcess = N / processes;
-            int remainder = N % processes;
+    if (rank == 0) {
+        std::cout << "Algorithm: " << options.algorithm << ", local multiply kernel: " << options.kernel << std::endl;
+    }
 
-            
-            std::vector<int> rowsPerProc(processes, rowsPerProcess);
-            for (int i = 0; i < remainder; ++i) {
-                rowsPerProc[i] += 1;
-            }
+    std::vector<Layout> layouts;
+    if (!layoutText.empty()) {
+        layouts = parseLayouts(layoutText);
+    }
+    else {
+        for (int processes : process_counts) {
+            layouts.push_back({ processes, options.threads });
+        }
+    }
 
-            
-            std::vector<double> A, B(N * N), C(rowsPerProc[rank] * N, 0);
-            std::vector<double> localA(rowsPerProc[rank] * N);
+    // Total time of every matrix size on one single-threaded process, the base of the speedup
+    std::map<int, double> serialTime;
+    std::vector<Row> rows;
 
+    for (const Layout& layout : layouts) {
+        int processes = layout.processes;
+        if (processes > size) {
             if (rank == 0) {
-                A.resize(N * N);
-                initializeMatrix(A, N, N);
-                initializeMatrix(B, N, N);
+                std::cout << "Skipped " << processes << " x " << layout.threads << ": only " << size << " processes" << std::endl;
             }
+            continue;
+        }
 
-            
-            if (rank == 0) {
-                for (int i = 1; i < processes; ++i) {
-                    MPI_Send(A.data() + std::accumulate(rowsPerProc.begin(), rowsPerProc.begin() + i, 0) * N,
-                        rowsPerProc[i] * N, MPI_DOUBLE, i, 0, MPI_COMM_WORLD);
-                }
-                std::copy(A.data(), A.data() + rowsPerProc[0] * N, localA.data());
-            }
-            else {
-                MPI_Recv(localA.data(), rowsPerProc[rank] * N, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            }
+        Options pointOptions = options;
+        pointOptions.threads = layout.threads;
+
+        if (rank == 0) {
+            std::cout << "Running with " << processes << " processes x " << layout.threads << " threads..." << std::endl;
+        }
 
-            
-            MPI_Bcast(B.data(), N * N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        // Only the first `processes` ranks take part
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < processes ? 0 : MPI_UNDEFINED, rank, &comm);
 
-            
-            double startTime = MPI_Wtime();
+        if (comm != MPI_COMM_NULL) {
+            for (int N : matrix_sizes) {
+                Result result;
+                if (options.algorithm == "pipeline") result = runPipelined(N, comm, pointOptions);
+                else if (options.algorithm == "shared") result = runSharedB(N, comm, pointOptions);
+                else if (options.algorithm == "summa") result = runSumma(N, comm, pointOptions);
+                else if (options.algorithm == "cannon") result = runCannon(N, comm, pointOptions);
+                else result = runRowSlab(N, comm, pointOptions);
 
-           
-            for (int i = 0; i < rowsPerProc[rank]; ++i) {
-                for (int j = 0; j < N; ++j) {
-                    for (int k = 0; k < N; ++k) {
-                        C[i * N + j] += localA[i * N + k] * B[k * N + j];
+                if (rank == 0) {
+                    if (!result.ran) {
+                        std::cout << "Skipped: " << options.algorithm << " needs a square number of processes" << std::endl;
+                        break;
                     }
-                }
-            }
 
-            double endTime = MPI_Wtime();
-            double localTime = endTime - startTime;
+                    if (processes == 1 && layout.threads == 1) {
+                        serialTime[N] = result.totalTime;
+                    }
+                    rows.push_back({ layout, N, result });
 
-            
-            double maxTime;
-            MPI_Reduce(&localTime, &maxTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+                    std::cout << "Matrix size: " << N << " x " << N << ", Number of processes: " << processes
+                        << ", threads per process: " << layout.threads << std::endl;
+                    std::cout << "Parallel execution time: " << result.totalTime << " seconds (compute "
+                        << result.computeTime << " seconds)\n";
+                    std::cout << "Exposed communication: " << std::max(0.0, result.totalTime - result.computeTime)
+                        << " seconds (" << 100.0 * std::max(0.0, 1.0 - result.computeTime / result.totalTime) << "% of total)\n";
+                    std::cout << "Matrix memory per node: " << result.nodeBytes / (1024.0 * 1024.0) << " MB\n";
+                    std::cout << "Performance: " << gemm::gflops(N, N, N, result.totalTime) << " GFLOP/s total, "
+                        << gemm::gflops(N, N, N, result.computeTime) / processes << " GFLOP/s per rank in compute\n";
 
-            
-            if (rank == 0) {
-                std::vector<double> fullC(N * N, 0);
-                std::copy(C.begin(), C.end(), fullC.begin());
+                    if (serialTime.count(N)) {
+                        std::cout << "Speedup for " << processes << " x " << layout.threads << ": " << serialTime[N] / result.totalTime << std::endl;
+                    }
 
-                for (int i = 1; i < processes; ++i) {
-                    MPI_Recv(fullC.data() + std::accumulate(rowsPerProc.begin(), rowsPerProc.begin() + i, 0) * N,
-                        rowsPerProc[i] * N, MPI_DOUBLE, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                    bool correct = std::fabs(result.checksum - result.expected) <= 1e-9 * std::max(1.0, std::fabs(result.expected));
+                    std::cout << "Checksum: " << result.checksum << (correct ? " (ok)" : " (MISMATCH)") << std::endl;
                 }
 
-                std::cout << "Parallel execution time: " << maxTime << " seconds\n";
-
-                
-                double serialTime = maxTime * processes; 
-                double speedup = (serialTime > 0) ? serialTime / maxTime : 1.0;
-                std::cout << "Speedup for " << processes << " processes: " << speedup << std::endl;
-            }
-            else {
-                MPI_Send(C.data(), rowsPerProc[rank] * N, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+                if (!result.ran) {
+                    break;
+                }
             }
 
-            MPI_Barrier(MPI_COMM_WORLD); 
+            MPI_Comm_free(&comm);
+        }
+
+        idleBarrier(MPI_COMM_WORLD);
+    }
+
+    if (rank == 0) {
+        std::cout << "\nLayout | Matrix size | Total Time (s) | Compute Time (s) | GFLOP/s | Memory per node (MB) | Checksum" << std::endl;
+        for (const Row& row : rows) {
+            bool correct = std::fabs(row.result.checksum - row.result.expected) <= 1e-9 * std::max(1.0, std::fabs(row.result.expected));
+            std::cout << row.layout.processes << "x" << row.layout.threads
+                << " | " << row.N
+                << " | " << row.result.totalTime
+                << " | " << row.result.computeTime
+                << " | " << gemm::gflops(row.N, row.N, row.N, row.result.totalTime)
+                << " | " << row.result.nodeBytes / (1024.0 * 1024.0)
+                << " | " << (correct ? "ok" : "MISMATCH") << std::endl;
         }
     }
 
@@ -0,0 +1,102 @@
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ctime>
+
+#include "philox.hpp"
+#include "batched_dot.hpp"
+
+// Many independent dot products: one blocking collective per scalar against
+// batched collectives, with and without compute/communication overlap.
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int pairs = 4096;          // Number of independent dot products
+    int local_length = 1000;   // Elements of each vector held by one rank
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--pairs") pairs = std::stoi(argv[i + 1]);
+        else if (arg == "--length") local_length = std::stoi(argv[i + 1]);
+        else if (arg == "--seed") seed = std::stoull(argv[i + 1]);
+    }
+
+    MPI_Bcast(&seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    // Each rank generates its own block of every vector (weak scaling in the vector length)
+    const size_t local_elements = static_cast<size_t>(pairs) * local_length;
+    std::vector<int> ia(local_elements), ib(local_elements);
+    for (int k = 0; k < pairs; ++k) {
+        uint64_t offset = (static_cast<uint64_t>(k) * size + rank) * local_length;
+        philox::fill_uniform_int(ia.data() + static_cast<size_t>(k) * local_length, offset, local_length, seed, 0, 0, 9);
+        philox::fill_uniform_int(ib.data() + static_cast<size_t>(k) * local_length, offset, local_length, seed, 1, 0, 9);
+    }
+    std::vector<double> a(ia.begin(), ia.end()), b(ib.begin(), ib.end());
+
+    std::vector<int> batch_sizes;
+    for (int batch = 1; batch <= pairs; batch *= 4) {
+        batch_sizes.push_back(batch);
+    }
+
+    std::vector<double> results(pairs), reference(pairs);
+
+    if (rank == 0) {
+        std::cout << "Processes: " << size << ", dot products: " << pairs
+            << ", local vector length: " << local_length << std::endl;
+        std::cout << "Batch | Collectives | Per-scalar Time (s) | Batched Time (s) | Overlapped Time (s)"
+            << " | Per-scalar us/dot | Batched us/dot | Overlapped us/dot" << std::endl;
+    }
+
+    // One blocking collective per scalar, the current MPI_2 pattern
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+    for (int k = 0; k < pairs; ++k) {
+        double partial = batched_dot::dot(a.data() + static_cast<size_t>(k) * local_length,
+            b.data() + static_cast<size_t>(k) * local_length, local_length);
+        MPI_Allreduce(&partial, &reference[k], 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    }
+    double per_scalar_time = MPI_Wtime() - start_time;
+    MPI_Allreduce(MPI_IN_PLACE, &per_scalar_time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    for (int batch : batch_sizes) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        start_time = MPI_Wtime();
+        int collectives = batched_dot::dot_batched(a.data(), b.data(), pairs, local_length, batch,
+            results.data(), MPI_COMM_WORLD, false);
+        double batched_time = MPI_Wtime() - start_time;
+        bool correct = results == reference;
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        start_time = MPI_Wtime();
+        batched_dot::dot_batched(a.data(), b.data(), pairs, local_length, batch,
+            results.data(), MPI_COMM_WORLD, true);
+        double overlapped_time = MPI_Wtime() - start_time;
+        correct = correct && results == reference;
+
+        // Slowest rank
+        MPI_Allreduce(MPI_IN_PLACE, &batched_time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &overlapped_time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            std::cout << batch << " | " << collectives
+                << " | " << per_scalar_time
+                << " | " << batched_time
+                << " | " << overlapped_time
+                << " | " << per_scalar_time / pairs * 1e6
+                << " | " << batched_time / pairs * 1e6
+                << " | " << overlapped_time / pairs * 1e6
+                << (correct ? "" : " | MISMATCH") << std::endl;
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,344 @@
+#include <mpi.h>
+#include <omp.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+
+#include "qmc.hpp"
+#include "quadrature.hpp"
+
+// Distributed Monte Carlo (Philox streams) and quasi-Monte Carlo (digitally
+// shifted Sobol points) integration over the unit cube in d dimensions.
+//
+// Samples 0..N-1 of every replicate are cut into one contiguous block per rank
+// and one sub-block per thread; each block starts by skipping ahead to its first
+// index. Threads keep Kahan sums per replicate, ranks combine them with
+// MPI_Allreduce. The estimate is the mean of REPLICATES independent replicates
+// (independent streams or independent shifts) and its error the standard error
+// of that mean. N doubles each round until the error is below the tolerance.
+
+const int REPLICATES = 16;
+
+enum class Method { MonteCarlo, QuasiMonteCarlo };
+
+struct Estimate {
+    double value = 0.0;
+    double error = 0.0;          // Standard error over the replicates
+    long long samples = 0;       // Points per replicate
+    int rounds = 0;
+    double time = 0.0;           // Slowest rank
+};
+
+// First index and count of the part-th of `parts` blocks of n items
+void block_range(long long n, int parts, int part, long long& first, long long& count) {
+    long long base = n / parts, extra = n % parts;
+    first = part * base + std::min<long long>(part, extra);
+    count = base + (part < extra ? 1 : 0);
+}
+
+// Sobol' g-function: prod_j (|4 x_j - 2| + a_j) / (1 + a_j) with a_j = j, integral 1
+struct GFunction {
+    double operator()(const double* x, int d) const {
+        double product = 1.0;
+        for (int j = 0; j < d; ++j) {
+            product *= (std::fabs(4.0 * x[j] - 2.0) + (j + 1)) / (j + 2.0);
+        }
+        return product;
+    }
+
+    double exact(int) const { return 1.0; }
+};
+
+// exp(-|x|^2 / d), integral (sqrt(pi d) / 2 * erf(1 / sqrt(d)))^d
+struct Gaussian {
+    double operator()(const double* x, int d) const {
+        double r2 = 0.0;
+        for (int j = 0; j < d; ++j) {
+            r2 += x[j] * x[j];
+        }
+        return std::exp(-r2 / d);
+    }
+
+    double exact(int d) const {
+        return std::pow(std::sqrt(M_PI * d) / 2.0 * std::erf(1.0 / std::sqrt(d)), d);
+    }
+};
+
+// Adds f over samples [first, first + count) of every replicate into sums[r]
+template <typename F>
+void sample_block(const F& f, int d, Method method, uint64_t seed, const qmc::Sobol& sobol,
+                  const std::vector<uint32_t>& shifts, long long first, long long count, qmc::Kahan* sums) {
+    std::vector<double> u(d);
+
+    if (method == Method::MonteCarlo) {
+        qmc::PhiloxStream stream(d, seed);
+        for (int r = 0; r < REPLICATES; ++r) {
+            for (long long i = first; i < first + count; ++i) {
+                stream.sample(r, i, u.data());
+                sums[r].add(f(u.data(), d));
+            }
+        }
+        return;
+    }
+
+    // One Sobol point serves every replicate, each with its own digital shift
+    std::vector<uint32_t> x(d);
+    if (count > 0) {
+        sobol.point(static_cast<uint32_t>(first), x.data());
+    }
+    for (long long i = first; i < first + count; ++i) {
+        for (int r = 0; r < REPLICATES; ++r) {
+            const uint32_t* shift = shifts.data() + static_cast<size_t>(r) * d;
+            for (int j = 0; j < d; ++j) {
+                u[j] = qmc::to_unit(x[j] ^ shift[j]);
+            }
+            sums[r].add(f(u.data(), d));
+        }
+        if (i + 1 < first + count) {
+            sobol.next(static_cast<uint32_t>(i), x.data());
+        }
+    }
+}
+
+// Refines until the standard error is below `tolerance` or max_samples points per replicate are used.
+// With tolerance 0 and first_samples == max_samples it is a single fixed-size run.
+template <typename F>
+Estimate integrate(const F& f, int d, Method method, double tolerance, long long first_samples, long long max_samples,
+                   int threads, uint64_t seed, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    qmc::Sobol sobol(method == Method::QuasiMonteCarlo ? d : 1);
+    std::vector<uint32_t> shifts = qmc::digital_shifts(d, REPLICATES, seed);
+    std::vector<qmc::Kahan> totals(REPLICATES);
+
+    Estimate estimate;
+    MPI_Barrier(comm);
+    double start_time = MPI_Wtime();
+
+    long long done = 0, target = std::min(first_samples, max_samples);
+    while (true) {
+        // New samples [done, target) of this round: a block per rank, a sub-block per thread
+        long long rank_first, rank_count;
+        block_range(target - done, size, rank, rank_first, rank_count);
+        rank_first += done;
+
+        // Sums and negated compensations of every replicate, combined over threads and ranks
+        std::vector<double> partial(2 * REPLICATES, 0.0);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            long long first, count;
+            block_range(rank_count, omp_get_num_threads(), omp_get_thread_num(), first, count);
+
+            qmc::Kahan sums[REPLICATES];
+            sample_block(f, d, method, seed, sobol, shifts, rank_first + first, count, sums);
+
+            #pragma omp critical
+            for (int r = 0; r < REPLICATES; ++r) {
+                partial[r] += sums[r].sum;
+                partial[REPLICATES + r] -= sums[r].compensation;
+            }
+        }
+
+        MPI_Allreduce(MPI_IN_PLACE, partial.data(), 2 * REPLICATES, MPI_DOUBLE, MPI_SUM, comm);
+
+        for (int r = 0; r < REPLICATES; ++r) {
+            totals[r].add(partial[r]);
+            totals[r].add(partial[REPLICATES + r]);
+        }
+        done = target;
+        ++estimate.rounds;
+
+        // Mean and standard error over the replicates
+        double mean = 0.0;
+        for (int r = 0; r < REPLICATES; ++r) {
+            mean += totals[r].value() / done;
+        }
+        mean /= REPLICATES;
+        double variance = 0.0;
+        for (int r = 0; r < REPLICATES; ++r) {
+            double deviation = totals[r].value() / done - mean;
+            variance += deviation * deviation;
+        }
+        variance /= REPLICATES - 1;
+
+        estimate.value = mean;
+        estimate.error = std::sqrt(variance / REPLICATES);
+        estimate.samples = done;
+
+        // Every rank has the same error, so every rank takes the same branch
+        if (estimate.error <= tolerance || done >= max_samples) {
+            break;
+        }
+        target = std::min(2 * done, max_samples);
+    }
+
+    double local_time = MPI_Wtime() - start_time;
+    MPI_Allreduce(&local_time, &estimate.time, 1, MPI_DOUBLE, MPI_MAX, comm);
+    return estimate;
+}
+
+const char* method_name(Method method) {
+    return method == Method::MonteCarlo ? "MC" : "QMC";
+}
+
+std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+// Accuracy, strong and weak scaling for one integrand
+template <typename F>
+void run_benchmarks(const F& f, const std::vector<int>& dims, const std::vector<Method>& methods, double tolerance,
+                    long long first_samples, long long max_samples, long long scaling_samples, int threads, uint64_t seed) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (rank == 0) {
+        std::cout << "\nRefinement to tolerance " << tolerance << " on " << size << " processes x " << threads << " threads" << std::endl;
+        std::cout << "Dimension | Method | Samples per Replicate | Evaluations | Rounds | Estimate | Estimated Error | Actual Error | Time (s)" << std::endl;
+    }
+    for (int d : dims) {
+        for (Method method : methods) {
+            Estimate e = integrate(f, d, method, tolerance, first_samples, max_samples, threads, seed, MPI_COMM_WORLD);
+            if (rank == 0) {
+                std::cout << d << " | " << method_name(method) << " | " << e.samples << " | " << e.samples * REPLICATES
+                    << " | " << e.rounds << " | " << e.value << " | " << e.error
+                    << " | " << std::fabs(e.value - f.exact(d)) << " | " << e.time << std::endl;
+            }
+        }
+    }
+
+    // Scaling at the largest dimension: the same total work (strong) and the same work per rank (weak)
+    int d = dims.back();
+    if (rank == 0) {
+        std::cout << "\nScaling, dimension " << d << ", " << threads << " threads per process" << std::endl;
+        std::cout << "Method | Processes | Strong Time (s) | Strong Speedup | Strong Efficiency | Weak Samples | Weak Time (s) | Weak Efficiency" << std::endl;
+    }
+    for (Method method : methods) {
+        double strong_base = 0.0, weak_base = 0.0;
+        for (int processes = 1; processes <= size; processes *= 2) {
+            MPI_Comm comm;
+            MPI_Comm_split(MPI_COMM_WORLD, rank < processes ? 0 : MPI_UNDEFINED, rank, &comm);
+
+            if (comm != MPI_COMM_NULL) {
+                long long weak_samples = scaling_samples * processes;
+                Estimate strong = integrate(f, d, method, 0.0, scaling_samples, scaling_samples, threads, seed, comm);
+                Estimate weak = integrate(f, d, method, 0.0, weak_samples, weak_samples, threads, seed, comm);
+
+                if (processes == 1) {
+                    strong_base = strong.time;
+                    weak_base = weak.time;
+                }
+                if (rank == 0) {
+                    std::cout << method_name(method) << " | " << processes
+                        << " | " << strong.time << " | " << strong_base / strong.time
+                        << " | " << strong_base / strong.time / processes
+                        << " | " << weak_samples << " | " << weak.time << " | " << weak_base / weak.time << std::endl;
+                }
+                MPI_Comm_free(&comm);
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Only the master thread of each rank calls MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (provided < MPI_THREAD_FUNNELED && rank == 0) {
+        std::cerr << "Warning: MPI library does not provide MPI_THREAD_FUNNELED." << std::endl;
+    }
+
+    std::vector<int> dims = { 4, 8, 12, 16, 20 };
+    std::string method = "both";        // "mc", "qmc" or "both"
+    std::string function = "g";         // "g" (Sobol' g-function) or "gauss"
+    double tolerance = 1e-4;
+    long long first_samples = 1 << 12;  // Points per replicate in the first round
+    long long max_samples = 1 << 22;    // Refinement stops here even above the tolerance
+    long long scaling_samples = 1 << 18;
+    int threads = omp_get_max_threads();
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--dims") dims = parse_list(argv[i + 1]);
+        else if (arg == "--method") method = argv[i + 1];
+        else if (arg == "--function") function = argv[i + 1];
+        else if (arg == "--tolerance") tolerance = std::stod(argv[i + 1]);
+        else if (arg == "--max-samples") max_samples = std::stoll(argv[i + 1]);
+        else if (arg == "--scaling-samples") scaling_samples = std::stoll(argv[i + 1]);
+        else if (arg == "--threads") threads = std::stoi(argv[i + 1]);
+        else if (arg == "--seed") seed = std::stoull(argv[i + 1]);
+    }
+    MPI_Bcast(&seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    bool valid_dims = !dims.empty();
+    for (int d : dims) {
+        valid_dims = valid_dims && d >= 1 && d <= qmc::SOBOL_MAX_DIMS;
+    }
+    if (!valid_dims || (method != "mc" && method != "qmc" && method != "both")
+        || (function != "g" && function != "gauss")) {
+        if (rank == 0) {
+            std::cerr << "Error: --dims must be in 1.." << qmc::SOBOL_MAX_DIMS
+                << ", --method 'mc', 'qmc' or 'both', --function 'g' or 'gauss'.\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::vector<Method> methods;
+    if (method != "qmc") methods.push_back(Method::MonteCarlo);
+    if (method != "mc") methods.push_back(Method::QuasiMonteCarlo);
+
+    // The OpenMP_3 baseline: integral() of x^2 on [0, 1] with the rectangle rule, against QMC at the same count
+    const long long N = 1000000;
+    auto square = [](double x) { return x * x; };
+    struct Square {
+        double operator()(const double* x, int) const { return x[0] * x[0]; }
+    };
+
+    double start_time = MPI_Wtime();
+    double rectangle = quadrature::rectangle(square, 0.0, 1.0, N, threads);
+    double rectangle_time = MPI_Wtime() - start_time;
+    Estimate sobol_1d = integrate(Square(), 1, Method::QuasiMonteCarlo, 0.0, N / REPLICATES, N / REPLICATES, threads, seed, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        std::cout << "1D x^2 on [0, 1] with " << N << " evaluations" << std::endl;
+        std::cout << "integral() rectangle rule, rank 0: " << rectangle << ", error " << std::fabs(rectangle - 1.0 / 3.0)
+            << ", time " << rectangle_time << " s" << std::endl;
+        std::cout << "Sobol QMC, " << size << " processes: " << sobol_1d.value << ", error " << std::fabs(sobol_1d.value - 1.0 / 3.0)
+            << " (estimated " << sobol_1d.error << "), time " << sobol_1d.time << " s" << std::endl;
+        std::cout << "Integrand: " << (function == "g" ? "Sobol' g-function" : "exp(-|x|^2 / d)")
+            << ", " << REPLICATES << " replicates" << std::endl;
+    }
+
+    if (function == "g") {
+        run_benchmarks(GFunction(), dims, methods, tolerance, first_samples, max_samples, scaling_samples, threads, seed);
+    }
+    else {
+        run_benchmarks(Gaussian(), dims, methods, tolerance, first_samples, max_samples, scaling_samples, threads, seed);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <mpi.h>
+#include <omp.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <unistd.h>
+
+#include "philox.hpp"
+#include "mpi_minmax.hpp"
+#include "sample_sort.hpp"
+
+// Distributed sample sort of a random key vector, on the MPI_1 skeleton: the
+// same Philox vector, block partition and sub-communicator sweep. The fused
+// min / max / sum reduction of MPI_1 gives the key range before the sort and
+// checks the result after it. Keys are sorted with OpenMP inside each rank,
+// split at regularly sampled splitters, exchanged with MPI_Alltoallv and merged
+// (see sample_sort.hpp).
+
+// Peak bytes per local key: the keys, the sort buffer and the received bucket (up to twice the keys)
+const double BYTES_PER_KEY = 4.0 * sizeof(int);
+
+// Elements [offset, offset + count) of the global random vector defined by seed, generated by `threads` threads.
+// Any rank can generate any part, and the parts match a serial run exactly.
+void generate_random_vector(std::vector<int>& vec, long long offset, long long count, uint64_t seed, int max_key, int threads) {
+    const long long CHUNK = 4096;   // Multiple of 4, so chunks start on a Philox block
+    vec.resize(count);
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (long long first = 0; first < count; first += CHUNK) {
+        philox::fill_uniform_int(vec.data() + first, offset + first, std::min(CHUNK, count - first), seed, 0, 0, max_key);
+    }
+}
+
+// Counts and displacements of a vector_size-element vector split over num_processes ranks.
+// The first vector_size % num_processes ranks get one extra element.
+void block_partition(long long vector_size, int num_processes, std::vector<int>& counts, std::vector<int>& displs) {
+    counts.assign(num_processes, static_cast<int>(vector_size / num_processes));
+    displs.assign(num_processes, 0);
+    for (int i = 0; i < vector_size % num_processes; ++i) {
+        counts[i] += 1;
+    }
+    for (int i = 1; i < num_processes; ++i) {
+        displs[i] = displs[i - 1] + counts[i - 1];
+    }
+}
+
+// True on every rank if the largest node of comm has the memory to sort vector_size keys
+bool fits_in_memory(long long vector_size, bool scatter, MPI_Comm comm) {
+    int rank, num_processes;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_processes);
+
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    double local_bytes = BYTES_PER_KEY * (vector_size / num_processes + 1);
+    if (scatter && rank == 0) {
+        local_bytes += static_cast<double>(vector_size) * sizeof(int);
+    }
+    double node_bytes;
+    MPI_Allreduce(&local_bytes, &node_bytes, 1, MPI_DOUBLE, MPI_SUM, node_comm);
+    MPI_Comm_free(&node_comm);
+
+    double available = 0.8 * static_cast<double>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+    int fits = node_bytes <= available ? 1 : 0, all_fit;
+    MPI_Allreduce(&fits, &all_fit, 1, MPI_INT, MPI_LAND, comm);
+    return all_fit != 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Only the master thread of each rank calls MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (provided < MPI_THREAD_FUNNELED && rank == 0) {
+        std::cerr << "Warning: MPI library does not provide MPI_THREAD_FUNNELED." << std::endl;
+    }
+
+    long long min_keys = 1000000;      // The sweep multiplies the key count by 10 from here
+    long long max_keys = 1000000000;   // Sizes that do not fit in memory are skipped
+    int max_key = INT_MAX;             // Keys are uniform in [0, max_key]
+    int threads = omp_get_max_threads();
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+
+    // "scatter": rank 0 generates the whole vector and scatters it
+    // "local":   every rank generates only its own block, nothing is scattered
+    std::string mode = "local";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--mode") mode = argv[i + 1];
+        else if (arg == "--seed") seed = std::stoull(argv[i + 1]);
+        else if (arg == "--min-keys") min_keys = std::stoll(argv[i + 1]);
+        else if (arg == "--max-keys") max_keys = std::stoll(argv[i + 1]);
+        else if (arg == "--max-key") max_key = std::stoi(argv[i + 1]);
+        else if (arg == "--threads") threads = std::stoi(argv[i + 1]);
+    }
+
+    if ((mode != "scatter" && mode != "local") || min_keys < 1 || max_keys >= INT_MAX || max_key < 0 || threads < 1) {
+        if (rank == 0) {
+            std::cerr << "Error: --mode must be 'scatter' or 'local', 1 <= --min-keys, --max-keys < " << INT_MAX
+                << ", --max-key >= 0, --threads >= 1.\n";
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    // Same seed on every rank, so all of them describe the same global vector
+    MPI_Bcast(&seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        std::cout << "Data generation mode: " << mode << ", seed: " << seed << ", keys in [0, " << max_key << "], "
+            << threads << " threads per process" << std::endl;
+        std::cout << "Keys | Processes | Time (s) | Keys/s | Local sort (s) | Sampling (s) | Exchange (s) | Merge (s) | Imbalance | Check" << std::endl;
+    }
+
+    // Datatype and MPI_Op of the single-pass min/max/sum reduction
+    auto fused = std::make_unique<mpi_minmax::FusedMinMax<int>>();
+
+    // Powers of two up to size, and size itself
+    std::vector<int> process_counts;
+    for (int p = 1; p < size; p *= 2) {
+        process_counts.push_back(p);
+    }
+    process_counts.push_back(size);
+
+    for (int num_processes : process_counts) {
+
+        // Only the first num_processes ranks take part in this sweep point
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < num_processes ? 0 : MPI_UNDEFINED, rank, &comm);
+
+        for (long long vector_size = min_keys; vector_size <= max_keys && comm != MPI_COMM_NULL; vector_size *= 10) {
+            if (!fits_in_memory(vector_size, mode == "scatter", comm)) {
+                if (rank == 0) {
+                    std::cout << vector_size << " | " << num_processes << " | skipped, needs more memory than the node has" << std::endl;
+                }
+                continue;
+            }
+
+            // Block size for each process
+            std::vector<int> counts, displs;
+            block_partition(vector_size, num_processes, counts, displs);
+
+            std::vector<int> local_data;
+
+            if (mode == "local") {
+                // Each working rank generates its own block of the global vector
+                generate_random_vector(local_data, displs[rank], counts[rank], seed, max_key, threads);
+            }
+            else {
+                std::vector<int> data;
+
+                if (rank == 0) {
+                    generate_random_vector(data, 0, vector_size, seed, max_key, threads);
+                }
+
+                local_data.resize(counts[rank]);
+
+                // Distribute the vector among the processes
+                MPI_Scatterv(data.data(), counts.data(), displs.data(), MPI_INT,
+                    local_data.data(), counts[rank], MPI_INT, 0, comm);
+            }
+
+            MPI_Barrier(comm);
+            double start_time = MPI_Wtime();
+
+            // Key range, position-independent checksum and count of the input in a single collective
+            mpi_minmax::MinMax<int> before = fused->allreduce(
+                mpi_minmax::local_minmax(local_data.data(), local_data.size(), displs[rank]), comm);
+
+            sample_sort::Timings timings;
+            std::vector<int> sorted = sample_sort::sort(std::move(local_data), before, comm, threads, &timings);
+
+            double local_time = MPI_Wtime() - start_time, duration;
+            MPI_Allreduce(&local_time, &duration, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+            // Globally sorted, and the same keys: min, max and sum are unchanged
+            bool ordered = sample_sort::is_globally_sorted(sorted, comm);
+            mpi_minmax::MinMax<int> after = fused->allreduce(mpi_minmax::local_minmax(sorted.data(), sorted.size()), comm);
+            long long local_count = static_cast<long long>(sorted.size()), largest_part, total;
+            MPI_Allreduce(&local_count, &largest_part, 1, MPI_LONG_LONG, MPI_MAX, comm);
+            MPI_Allreduce(&local_count, &total, 1, MPI_LONG_LONG, MPI_SUM, comm);
+            bool same_keys = total == vector_size && after.min == before.min && after.max == before.max && after.sum == before.sum;
+
+            double phases[4] = { timings.local_sort, timings.sampling, timings.exchange, timings.merge }, slowest[4];
+            MPI_Reduce(phases, slowest, 4, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+            if (rank == 0) {
+                std::cout << vector_size << " | "
+                    << num_processes << " | "
+                    << duration << " | "
+                    << vector_size / duration << " | "
+                    << slowest[0] << " | "
+                    << slowest[1] << " | "
+                    << slowest[2] << " | "
+                    << slowest[3] << " | "
+                    << largest_part * static_cast<double>(num_processes) / vector_size << " | "
+                    << (ordered && same_keys ? "sorted" : (ordered ? "KEYS CHANGED" : "NOT SORTED")) << std::endl;
+            }
+        }
+
+        if (comm != MPI_COMM_NULL) {
+            MPI_Comm_free(&comm);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    fused.reset();
+
+    MPI_Finalize();
+    return 0;
+}
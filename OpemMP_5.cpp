@@ -5,18 +5,45 @@
 #include <algorithm>
 #include <chrono>
 #include <climits>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "band_matrix.hpp"
+#include "sparse.hpp"
+#include "autotune.hpp"
 
 using namespace std;
+using matrix::Matrix;
+using band::BandMatrix;
+using sparse::Csr;
+using sparse::Sell;
+
+// Rows per block of the banded kernels
+const int BAND_BLOCK = 256;
 
 // A function for generating a ribbon matrix
-vector<vector<int>> generate_band_matrix(int n, int k) {
-    vector<vector<int>> matrix(n, vector<int>(n, 0));
+Matrix<int> generate_band_matrix(int n, int k, unsigned seed) {
+    Matrix<int> matrix(n, n, 0);
 
-    random_device rd;
-    mt19937 gen(rd());
+    mt19937 gen(seed);
     uniform_int_distribution<> dis(1, 100); // Generating random numbers from 1 to 100
 
     // Filling in the feed
+    for (int i = 0; i < n; ++i) {
+        for (int j = max(0, i - k); j <= min(n - 1, i + k); ++j) {
+            matrix(i, j) = dis(gen);
+        }
+    }
+    return matrix;
+}
+
+// The same matrix in the old vector<vector<int>> layout (one allocation per row)
+vector<vector<int>> generate_band_matrix_nested(int n, int k, unsigned seed) {
+    vector<vector<int>> matrix(n, vector<int>(n, 0));
+
+    mt19937 gen(seed);
+    uniform_int_distribution<> dis(1, 100);
+
     for (int i = 0; i < n; ++i) {
         for (int j = max(0, i - k); j <= min(n - 1, i + k); ++j) {
             matrix[i][j] = dis(gen);
@@ -25,61 +52,289 @@ vector<vector<int>> generate_band_matrix(int n, int k) {
     return matrix;
 }
 
-int max_of_min_elements(const vector<vector<int>>& matrix, int threads, const string& distribution) {
-    int n = matrix.size();
-    int max_of_mins = INT_MIN; 
+// The same matrix in (2k+1) x n band storage, O(n * k) memory
+BandMatrix<int> generate_band_storage(int n, int k, unsigned seed) {
+    BandMatrix<int> matrix(n, k);
 
-    omp_set_num_threads(threads);
+    mt19937 gen(seed);
+    uniform_int_distribution<> dis(1, 100);
+
+    for (int i = 0; i < n; ++i) {
+        for (int j = max(0, i - k); j <= min(n - 1, i + k); ++j) {
+            matrix.at(i, j) = dis(gen);
+        }
+    }
+    return matrix;
+}
+
+// Maximum of row_min(i) over n rows (or row blocks) under a tuned schedule
+template <typename RowMin>
+int max_of_row_mins(int n, const autotune::Schedule& schedule, RowMin row_min) {
+    int max_of_mins = INT_MIN;
+
+    autotune::apply(schedule);
+
+    #pragma omp parallel for schedule(runtime) reduction(max:max_of_mins) num_threads(schedule.threads)
+    for (int i = 0; i < n; ++i) {
+        max_of_mins = max(max_of_mins, row_min(i));
+    }
+
+    return max_of_mins;
+}
+
+// Maximum of row_min(i) over n rows (or row blocks), with the rows split by the given schedule.
+// "auto" uses the schedule, chunk and thread count (at most threads) the autotuner
+// found fastest for this kernel and n; the first run on a host tunes and caches it.
+template <typename RowMin>
+int max_of_row_mins(int n, int threads, const string& distribution, RowMin row_min, const string& kernel) {
+    int max_of_mins = INT_MIN;
 
+    if (distribution == "auto") {
+        autotune::Schedule best = autotune::tune(kernel, n, threads,
+            [&](const autotune::Schedule& s) { max_of_row_mins(n, s, row_min); });
+        return max_of_row_mins(n, best, row_min);
+    }
+
+    omp_set_num_threads(threads);
 
     if (distribution == "static") {
         #pragma omp parallel for schedule(static) reduction(max:max_of_mins)
         for (int i = 0; i < n; ++i) {
-            int row_min = *min_element(matrix[i].begin(), matrix[i].end());
-            max_of_mins = max(max_of_mins, row_min);
+            max_of_mins = max(max_of_mins, row_min(i));
         }
     }
     else if (distribution == "dynamic") {
         #pragma omp parallel for schedule(dynamic) reduction(max:max_of_mins)
         for (int i = 0; i < n; ++i) {
-            int row_min = *min_element(matrix[i].begin(), matrix[i].end());
-            max_of_mins = max(max_of_mins, row_min); 
+            max_of_mins = max(max_of_mins, row_min(i));
         }
     }
     else if (distribution == "guided") {
         #pragma omp parallel for schedule(guided) reduction(max:max_of_mins)
         for (int i = 0; i < n; ++i) {
-            int row_min = *min_element(matrix[i].begin(), matrix[i].end()); 
-            max_of_mins = max(max_of_mins, row_min); 
+            max_of_mins = max(max_of_mins, row_min(i));
         }
     }
 
     return max_of_mins;
 }
 
-int main() {
+int max_of_min_elements(const Matrix<int>& matrix, int threads, const string& distribution) {
+    return max_of_row_mins(matrix.rows(), threads, distribution,
+        [&](int i) { return matrix::row_min(matrix, i); }, "max_of_min_elements");
+}
+
+// The original search over the vector<vector<int>> layout, kept as the baseline
+int max_of_min_elements_nested(const vector<vector<int>>& matrix, int threads, const string& distribution) {
+    return max_of_row_mins(static_cast<int>(matrix.size()), threads, distribution,
+        [&](int i) { return *min_element(matrix[i].begin(), matrix[i].end()); }, "max_of_min_elements_nested");
+}
+
+// Works on blocks of rows: the minimums of a block come from its 2k+1 diagonals,
+// the zeros outside the band are accounted for without being read
+int max_of_min_elements_banded(const BandMatrix<int>& matrix, int threads, const string& distribution) {
+    int n = matrix.n();
+    int blocks = (n + BAND_BLOCK - 1) / BAND_BLOCK;
+    return max_of_row_mins(blocks, threads, distribution, [&](int b) {
+        int mins[BAND_BLOCK];
+        int first = b * BAND_BLOCK, last = min(n, first + BAND_BLOCK);
+        band::row_mins(matrix, first, last, mins);
+        return *max_element(mins, mins + (last - first));
+    }, "max_of_min_elements_banded");
+}
+
+// Seconds taken by f(), the best of `repetitions` runs so both layouts are measured warm
+template <typename F>
+double time_it(F&& f, int repetitions = 1) {
+    double best = 0.0;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = chrono::high_resolution_clock::now();
+        f();
+        auto end = chrono::high_resolution_clock::now();
+        double seconds = chrono::duration<double>(end - start).count();
+        best = r == 0 ? seconds : min(best, seconds);
+    }
+    return best;
+}
+
+double max_difference(const vector<double>& a, const vector<double>& b) {
+    double diff = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = max(diff, fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+// body(i) for i in [0, n) under the given schedule
+template <typename Body>
+void for_each_row(int n, int threads, const string& distribution, Body body) {
+    omp_set_num_threads(threads);
+
+    if (distribution == "static") {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) {
+            body(i);
+        }
+    }
+    else if (distribution == "dynamic") {
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < n; ++i) {
+            body(i);
+        }
+    }
+    else if (distribution == "guided") {
+        #pragma omp parallel for schedule(guided)
+        for (int i = 0; i < n; ++i) {
+            body(i);
+        }
+    }
+}
+
+// Sparse y = A * x, one row (CSR) or one chunk of rows (SELL) per loop iteration
+void csr_spmv(const Csr<int>& matrix, const vector<double>& x, vector<double>& y, int threads, const string& distribution) {
+    for_each_row(matrix.rows, threads, distribution,
+        [&](int i) { sparse::spmv(matrix, x.data(), y.data(), i, i + 1); });
+}
+
+void sell_spmv(const Sell<int>& matrix, const vector<double>& x, vector<double>& y, int threads, const string& distribution) {
+    for_each_row(matrix.chunks(), threads, distribution,
+        [&](int c) { sparse::spmv(matrix, x.data(), y.data(), c, c + 1); });
+}
+
+// Runs CSR and SELL-C-sigma SpMV over every thread count and schedule
+void spmv_sweep(const string& name, const Csr<int>& csr, int chunk, int sigma) {
+    Sell<int> sell = sparse::to_sell(csr, chunk, sigma);
+
+    int n = csr.rows;
+    vector<double> x(csr.cols), reference(n), y(n);
+    for (int j = 0; j < csr.cols; ++j) {
+        x[j] = 1.0 / (j + 1);
+    }
+    sparse::spmv(csr, x.data(), reference.data(), 0, n);
+
+    cout << "\n" << name << ": " << n << " rows, " << csr.nnz() << " nonzeros, SELL-" << chunk << "-" << sigma
+        << " padding " << 100.0 * (sell.stored() - sell.nnz) / max<long long>(1, sell.nnz) << "%" << endl;
+    cout << "Format | Threads | Distribution | Time (s) | GB/s | GFLOP/s" << endl;
+
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        for (const string& distribution : { "static", "dynamic", "guided" }) {
+            double csr_time = time_it([&]() { csr_spmv(csr, x, y, threads, distribution); }, 3);
+            bool csr_ok = max_difference(y, reference) <= 1e-9 * n;
+            double sell_time = time_it([&]() { sell_spmv(sell, x, y, threads, distribution); }, 3);
+            bool sell_ok = max_difference(y, reference) <= 1e-9 * n;
+
+            cout << "CSR | " << threads << " | " << distribution << " | " << csr_time << " | "
+                << sparse::traffic_bytes(csr) / csr_time / 1e9 << " | "
+                << sparse::gflops(csr.nnz(), csr_time) << (csr_ok ? "" : " | MISMATCH") << endl;
+            cout << "SELL | " << threads << " | " << distribution << " | " << sell_time << " | "
+                << sparse::traffic_bytes(sell) / sell_time / 1e9 << " | "
+                << sparse::gflops(sell.nnz, sell_time) << (sell_ok ? "" : " | MISMATCH") << endl;
+        }
+    }
+}
+
+// y = A * x over the dense matrix
+void dense_matvec(const Matrix<int>& matrix, const vector<double>& x, vector<double>& y, int threads) {
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (int i = 0; i < matrix.rows(); ++i) {
+        const int* row = matrix.row_data(i);
+        double sum = 0.0;
+        #pragma omp simd reduction(+:sum)
+        for (int j = 0; j < matrix.cols(); ++j) {
+            sum += row[j] * x[j];
+        }
+        y[i] = sum;
+    }
+}
+
+// y = A * x over the band storage
+void banded_matvec(const BandMatrix<int>& matrix, const vector<double>& x, vector<double>& y, int threads) {
+    int n = matrix.n();
+    int blocks = (n + BAND_BLOCK - 1) / BAND_BLOCK;
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (int b = 0; b < blocks; ++b) {
+        band::matvec(matrix, x.data(), y.data(), b * BAND_BLOCK, min(n, (b + 1) * BAND_BLOCK));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // --retune ignores the autotuner cache and tunes the "auto" rows again
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--retune") autotune::set_retune(true);
+    }
+
     vector<int> matrix_sizes = { 100, 1000, 5000, 10000 };
     int k = 10;    // Width of the tape
-
-    cout << "Matrix Size | Threads | Execution Time (s) | Distribution" << endl;
+    const unsigned seed = random_device{}();
 
     for (int n : matrix_sizes) {
-        vector<vector<int>> matrix = generate_band_matrix(n, k);
+        vector<vector<int>> nested;
+        double nested_setup = time_it([&]() { nested = generate_band_matrix_nested(n, k, seed); });
+
+        Matrix<int> matrix;
+        double contiguous_setup = time_it([&]() { matrix = generate_band_matrix(n, k, seed); });
+
+        BandMatrix<int> banded;
+        double banded_setup = time_it([&]() { banded = generate_band_storage(n, k, seed); });
+
+        cout << n << "x" << n << " setup: vector<vector> " << nested_setup
+            << " s, Matrix " << contiguous_setup << " s (" << matrix.bytes() / 1e6 << " MB), band "
+            << banded_setup << " s (" << banded.bytes() / 1e6 << " MB)" << endl;
+        cout << "Matrix Size | Threads | Nested Time (s) | Contiguous Time (s) | Banded Time (s) | Layout Gain | Band Gain | Distribution" << endl;
 
         for (int threads = 1; threads <= 8; threads *= 2) {
-            for (const string& distribution : { "static", "dynamic", "guided" }) {
-                auto start = chrono::high_resolution_clock::now();
-                int result = max_of_min_elements(matrix, threads, distribution);
-                auto end = chrono::high_resolution_clock::now();
+            for (const string& distribution : { "static", "dynamic", "guided", "auto" }) {
+                int result_nested = 0, result = 0, result_banded = 0;
+                double nested_time = time_it([&]() { result_nested = max_of_min_elements_nested(nested, threads, distribution); }, 3);
+                double duration = time_it([&]() { result = max_of_min_elements(matrix, threads, distribution); }, 3);
+                double banded_time = time_it([&]() { result_banded = max_of_min_elements_banded(banded, threads, distribution); }, 3);
 
-                chrono::duration<double> duration = end - start;
                 cout << n << "x" << n << " | "
                     << threads << " | "
-                    << duration.count() << " | "
-                    << distribution << endl;
+                    << nested_time << " | "
+                    << duration << " | "
+                    << banded_time << " | "
+                    << nested_time / duration << " | "
+                    << duration / banded_time << " | "
+                    << distribution
+                    << (result == result_nested && result == result_banded ? "" : " | MISMATCH") << endl;
             }
         }
+
+        vector<double> x(n), y_dense(n), y_banded(n);
+        for (int j = 0; j < n; ++j) {
+            x[j] = 1.0 / (j + 1);
+        }
+        double dense_time = time_it([&]() { dense_matvec(matrix, x, y_dense, 1); }, 3);
+        double banded_time = time_it([&]() { banded_matvec(banded, x, y_banded, 1); }, 3);
+        cout << n << "x" << n << " matvec, 1 thread: dense " << dense_time << " s, banded " << banded_time
+            << " s, max difference " << max_difference(y_dense, y_banded) << endl;
     }
 
+    // Sizes where the dense matrix would no longer fit: only the band storage is built
+    cout << "\nBand storage only (k = " << k << ")" << endl;
+    cout << "Matrix Size | Threads | Memory (MB) | Max of Min Time (s) | Matvec Time (s)" << endl;
+    for (int n : { 100000, 1000000, 4000000 }) {
+        BandMatrix<int> banded = generate_band_storage(n, k, seed);
+        vector<double> x(n, 1.0), y(n);
+
+        for (int threads = 1; threads <= 8; threads *= 2) {
+            double row_min_time = time_it([&]() { max_of_min_elements_banded(banded, threads, "static"); }, 3);
+            double matvec_time = time_it([&]() { banded_matvec(banded, x, y, threads); }, 3);
+            cout << n << "x" << n << " | "
+                << threads << " | "
+                << banded.bytes() / 1e6 << " | "
+                << row_min_time << " | "
+                << matvec_time << endl;
+        }
+    }
+
+    // Sparse matrix-vector multiply: the uniform band, then heavy-tailed rows that unbalance a static split
+    const int sell_chunk = 8, sell_sigma = 256;
+    spmv_sweep("Band matrix (k = " + to_string(k) + ")", sparse::from_band(generate_band_storage(1000000, k, seed)),
+        sell_chunk, sell_sigma);
+    spmv_sweep("Irregular matrix (Pareto row lengths, mean 16)", sparse::irregular<int>(1000000, 16.0, seed),
+        sell_chunk, sell_sigma);
+
     return 0;
 }
@@ -5,119 +5,129 @@
 #include <cstdlib>
 #include <ctime>
 
-int main() {
-    const std::vector<int> vector_sizes = { 1000, 10000, 100000, 1000000 }; // vector dimension
-    const std::vector<int> thread_counts = { 1, 2, 4, 8 };                  // number of threads
+#include "minmax_simd.hpp"
+
+// min/max with the OpenMP reduction clause
+double minmax_reduction(const std::vector<int>& data, int& min_value, int& max_value) {
+    const int size = data.size();
+    min_value = std::numeric_limits<int>::max();
+    max_value = std::numeric_limits<int>::min();
+
+    double start_time = omp_get_wtime();
+    #pragma omp parallel for reduction(min:min_value) reduction(max:max_value)
+    for (int i = 0; i < size; i++) {
+        if (data[i] < min_value) min_value = data[i];
+        if (data[i] > max_value) max_value = data[i];
+    }
+    return omp_get_wtime() - start_time;
+}
 
-    std::cout << "Vector Size | Threads | Reduction Time (s) | No Reduction Time (s) | Speedup (Reduction) | Speedup (No Reduction)\n";
+// min/max with per-thread locals combined in a critical section
+double minmax_no_reduction(const std::vector<int>& data, int& min_value, int& max_value) {
+    const int size = data.size();
+    min_value = std::numeric_limits<int>::max();
+    max_value = std::numeric_limits<int>::min();
 
-    for (int size : vector_sizes) {
-        std::vector<int> data(size);
+    double start_time = omp_get_wtime();
+    #pragma omp parallel
+    {
+        int local_min = std::numeric_limits<int>::max();
+        int local_max = std::numeric_limits<int>::min();
 
-        std::srand(std::time(nullptr));
+        #pragma omp for
         for (int i = 0; i < size; i++) {
-            data[i] = std::rand() % 1000; // from 0 to 999
+            if (data[i] < local_min) local_min = data[i];
+            if (data[i] > local_max) local_max = data[i];
         }
 
-        // 1 thread with reduction
-        omp_set_num_threads(1);
-
-        int min_value = std::numeric_limits<int>::max();
-        int max_value = std::numeric_limits<int>::min();
-
-        double start_time = omp_get_wtime();
-        #pragma omp parallel for reduction(min:min_value) reduction(max:max_value)
-        for (int i = 0; i < size; i++) {
-            if (data[i] < min_value) min_value = data[i];
-            if (data[i] > max_value) max_value = data[i];
+        #pragma omp critical
+        {
+            if (local_min < min_value) min_value = local_min;
+            if (local_max > max_value) max_value = local_max;
         }
-        double one_thread_reduction_time = omp_get_wtime() - start_time;
+    }
+    return omp_get_wtime() - start_time;
+}
 
-        // 1 thread without reduction
-        min_value = std::numeric_limits<int>::max();
-        max_value = std::numeric_limits<int>::min();
+// min/max with the vectorized kernel on each thread's contiguous block
+double minmax_simd_kernel(const std::vector<int>& data, int& min_value, int& max_value) {
+    const size_t size = data.size();
+    min_value = std::numeric_limits<int>::max();
+    max_value = std::numeric_limits<int>::min();
+
+    double start_time = omp_get_wtime();
+    #pragma omp parallel reduction(min:min_value) reduction(max:max_value)
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        size_t begin = size * tid / nthreads;
+        size_t end = size * (tid + 1) / nthreads;
+
+        minmax_simd::minmax(data.data() + begin, end - begin, min_value, max_value);
+    }
+    return omp_get_wtime() - start_time;
+}
 
-        start_time = omp_get_wtime();
-        #pragma omp parallel
-        {
-            int local_min = std::numeric_limits<int>::max();
-            int local_max = std::numeric_limits<int>::min();
+int main() {
+    const std::vector<int> vector_sizes = { 1000, 10000, 100000, 1000000, 10000000, 100000000 }; // vector dimension
+    const std::vector<int> thread_counts = { 1, 2, 4, 8 };                  // number of threads
 
-            #pragma omp for
-            for (int i = 0; i < size; i++) {
-                if (data[i] < local_min) local_min = data[i];
-                if (data[i] > local_max) local_max = data[i];
-            }
+    std::cout << "SIMD kernel: " << minmax_simd::isa_name() << "\n";
+    std::cout << "Vector Size | Threads | Reduction Time (s) | No Reduction Time (s) | SIMD Time (s) | Speedup (Reduction) | Speedup (No Reduction) | Speedup (SIMD)"
+        << " | Reduction GB/s | No Reduction GB/s | SIMD GB/s\n";
 
-            #pragma omp critical
-            {
-                if (local_min < min_value) min_value = local_min;
-                if (local_max > max_value) max_value = local_max;
-            }
+    for (int size : vector_sizes) {
+        std::vector<int> data(size);
+
+        std::srand(std::time(nullptr));
+        for (int i = 0; i < size; i++) {
+            data[i] = std::rand() % 1000; // from 0 to 999
         }
-        double one_thread_no_reduction_time = omp_get_wtime() - start_time;
 
-        // result for 1 thread
-        std::cout << size << "         | "
-            << 1 << "       | "
-            << one_thread_reduction_time << "             | "
-            << one_thread_no_reduction_time << "               | "
-            << 1.0 << "              | "
-            << 1.0 << "\n"; 
+        const double gigabytes = static_cast<double>(size) * sizeof(int) / 1e9;
 
-        // for other threads
-        for (int threads : thread_counts) {
-            if (threads == 1) continue; 
+        double one_thread_reduction_time = 0.0;
+        double one_thread_no_reduction_time = 0.0;
+        double one_thread_simd_time = 0.0;
 
+        for (int threads : thread_counts) {
             omp_set_num_threads(threads);
 
-            min_value = std::numeric_limits<int>::max();
-            max_value = std::numeric_limits<int>::min();
+            int min_value, max_value;
+            double reduction_time = minmax_reduction(data, min_value, max_value);
+            int expected_min = min_value, expected_max = max_value;
+
+            double no_reduction_time = minmax_no_reduction(data, min_value, max_value);
 
-            // with reduction
-            start_time = omp_get_wtime();
-            #pragma omp parallel for reduction(min:min_value) reduction(max:max_value)
-            for (int i = 0; i < size; i++) {
-                if (data[i] < min_value) min_value = data[i];
-                if (data[i] > max_value) max_value = data[i];
+            double simd_time = minmax_simd_kernel(data, min_value, max_value);
+            if (min_value != expected_min || max_value != expected_max) {
+                std::cerr << "SIMD result mismatch for size " << size << "\n";
+                return 1;
             }
-            double reduction_time = omp_get_wtime() - start_time;
-
-            // without reduction
-            min_value = std::numeric_limits<int>::max();
-            max_value = std::numeric_limits<int>::min();
-
-            start_time = omp_get_wtime();
-            #pragma omp parallel
-            {
-                int local_min = std::numeric_limits<int>::max();
-                int local_max = std::numeric_limits<int>::min();
-
-                #pragma omp for
-                for (int i = 0; i < size; i++) {
-                    if (data[i] < local_min) local_min = data[i];
-                    if (data[i] > local_max) local_max = data[i];
-                }
-
-                #pragma omp critical
-                {
-                    if (local_min < min_value) min_value = local_min;
-                    if (local_max > max_value) max_value = local_max;
-                }
+
+            if (threads == 1) {
+                one_thread_reduction_time = reduction_time;
+                one_thread_no_reduction_time = no_reduction_time;
+                one_thread_simd_time = simd_time;
             }
-            double no_reduction_time = omp_get_wtime() - start_time;
 
             // speedup (t on 1/t on the current)
             double speedup_reduction = one_thread_reduction_time / reduction_time;
             double speedup_no_reduction = one_thread_no_reduction_time / no_reduction_time;
+            double speedup_simd = one_thread_simd_time / simd_time;
 
             //results
             std::cout << size << "         | "
                 << threads << "       | "
                 << reduction_time << "             | "
                 << no_reduction_time << "               | "
+                << simd_time << "     | "
                 << speedup_reduction << "              | "
-                << speedup_no_reduction << "\n";
+                << speedup_no_reduction << "              | "
+                << speedup_simd << "     | "
+                << gigabytes / reduction_time << "     | "
+                << gigabytes / no_reduction_time << "     | "
+                << gigabytes / simd_time << "\n";
         }
     }
 
@@ -3,6 +3,9 @@
 #include <cmath>
 #include <omp.h>
 #include <chrono>
+#include <string>
+
+#include "quadrature.hpp"
 
 using namespace std;
 
@@ -25,6 +28,56 @@ double integral(double a, double b, int N, int num_threads) {
     return sum;
 }
 
+// Seconds taken by f()
+template <typename F>
+double time_it(F&& f) {
+    auto start = chrono::high_resolution_clock::now();
+    f();
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+// Evaluations and time each method needs to reach the target errors on one integrand
+template <typename F>
+void accuracy_benchmark(const string& name, F fn, double a, double b, double exact,
+                        const vector<double>& targets, const vector<int>& thread_counts) {
+    int max_threads = thread_counts.back();
+
+    // Rectangle rule: double N until the error is below each target, up to N_MAX points
+    const long long N_MAX = 1LL << 28;
+    size_t next_target = 0;
+    long long N = 1000;
+    for (; N <= N_MAX && next_target < targets.size(); N *= 2) {
+        double result = 0.0;
+        double time = time_it([&]() { result = quadrature::rectangle(fn, a, b, N, max_threads); });
+        double error = fabs(result - exact);
+        while (next_target < targets.size() && error <= targets[next_target]) {
+            cout << name << " | rectangle | " << targets[next_target] << " | " << max_threads
+                << " | " << N << " | " << time << " | " << error << endl;
+            ++next_target;
+        }
+    }
+    for (; next_target < targets.size(); ++next_target) {
+        cout << name << " | rectangle | " << targets[next_target] << " | " << max_threads
+            << " | > " << N_MAX << " | - | not reached" << endl;
+    }
+
+    // Adaptive rules, every thread count
+    auto run = [&](const string& rule_name, const auto& rule) {
+        for (double target : targets) {
+            for (int threads : thread_counts) {
+                quadrature::Estimate estimate;
+                double time = time_it([&]() { estimate = quadrature::integrate(fn, a, b, target, rule, threads); });
+                cout << name << " | " << rule_name << " | " << target << " | " << threads
+                    << " | " << estimate.evaluations << " | " << time << " | " << fabs(estimate.value - exact) << endl;
+            }
+        }
+    };
+    run("adaptive Simpson", quadrature::Simpson());
+    run("adaptive Gauss-Legendre 5", quadrature::GaussLegendre());
+    run("adaptive Gauss-Kronrod 7-15", quadrature::GaussKronrod());
+}
+
 int main() {
     double a = 0.0;  // The beginning of the interval
     double b = 1.0;  // The end of the interval
@@ -64,5 +117,14 @@ int main() {
         }
     }
 
+    // Work needed to reach a target error: fixed-step rectangle rule against adaptive task-parallel rules
+    vector<double> targets = { 1e-6, 1e-9, 1e-12 };
+
+    cout << "\nFunction | Method | Target Error | Threads | Evaluations | Time (s) | Actual Error" << endl;
+    accuracy_benchmark("x^2", [](double x) { return f(x); }, a, b, 1.0 / 3.0, targets, thread_counts);
+    accuracy_benchmark("sqrt(x)", [](double x) { return sqrt(x); }, a, b, 2.0 / 3.0, targets, thread_counts);
+    accuracy_benchmark("exp(-x)cos(20x)", [](double x) { return exp(-x) * cos(20.0 * x); }, a, b,
+        (exp(-1.0) * (20.0 * sin(20.0) - cos(20.0)) + 1.0) / 401.0, targets, thread_counts);
+
     return 0;
 }
@@ -2,22 +2,48 @@
 #include <vector>
 #include <cstdlib>
 #include <ctime>
+#include <climits>
 #include <omp.h>
 #include <chrono>
 
+#include "matrix.hpp"
+#include "philox.hpp"
+
 using namespace std;
+using matrix::Matrix;
 
-// A function for generating a random matrix
-void generateMatrix(vector<vector<int>>& matrix, int rows, int cols) {
+// A function for generating a random matrix. Rows are generated in parallel;
+// element (i, j) is element i * cols + j of a Philox stream, so the values do not
+// depend on the number of threads
+void generateMatrix(Matrix<int>& matrix, int rows, int cols, uint64_t seed) {
+    #pragma omp parallel for schedule(static)
     for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            matrix[i][j] = rand() % 1000;
-        }
+        philox::fill_uniform_int(matrix.row_data(i), static_cast<uint64_t>(i) * cols, cols, seed, 0, 0, 999);
+    }
+}
+
+// The same matrix in the old vector<vector<int>> layout (one allocation per row)
+void generateNestedMatrix(vector<vector<int>>& matrix, int rows, int cols, uint64_t seed) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; ++i) {
+        philox::fill_uniform_int(matrix[i].data(), static_cast<uint64_t>(i) * cols, cols, seed, 0, 0, 999);
     }
 }
 
 // A function for searching for the maximum among the minimum elements of strings
-int findMaxOfMins(const vector<vector<int>>& matrix, int rows, int cols, int num_threads) {
+int findMaxOfMins(const Matrix<int>& matrix, int num_threads) {
+    int max_min = INT_MIN;
+
+#pragma omp parallel for reduction(max:max_min) num_threads(num_threads)
+    for (int i = 0; i < matrix.rows(); ++i) {
+        max_min = max(max_min, matrix::row_min(matrix, i));
+    }
+
+    return max_min;
+}
+
+// The original search over the vector<vector<int>> layout, kept as the baseline
+int findMaxOfMinsNested(const vector<vector<int>>& matrix, int rows, int cols, int num_threads) {
     int max_min = INT_MIN;
 
 #pragma omp parallel for reduction(max:max_min) num_threads(num_threads)
@@ -34,46 +60,65 @@ int findMaxOfMins(const vector<vector<int>>& matrix, int rows, int cols, int num
     return max_min;
 }
 
+// Seconds taken by f(), the best of `repetitions` runs so both layouts are measured warm
+template <typename F>
+double timeIt(F&& f, int repetitions = 1) {
+    double best = 0.0;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = chrono::high_resolution_clock::now();
+        f();
+        auto end = chrono::high_resolution_clock::now();
+        double seconds = chrono::duration<double>(end - start).count();
+        best = r == 0 ? seconds : min(best, seconds);
+    }
+    return best;
+}
+
 int main() {
     // Dimensions of the matrix (rows x cols)
     vector<pair<int, int>> matrix_sizes = { {100, 100}, {1000, 1000}, {5000, 5000}, {10000, 10000} };
-    vector<int> thread_counts = { 1, 2, 4, 8 }; 
-    
-    cout << "Matrix Size | Threads | Execution Time (s) | Speedup | Max of Min" << endl;
+    vector<int> thread_counts = { 1, 2, 4, 8 };
+    const uint64_t seed = static_cast<uint64_t>(time(nullptr));
 
-    
     for (auto& size : matrix_sizes) {
         int rows = size.first;
         int cols = size.second;
 
-        vector<vector<int>> matrix(rows, vector<int>(cols));
-        generateMatrix(matrix, rows, cols);
+        // Allocation + generation of both layouts from the same seed
+        vector<vector<int>> nested;
+        double nested_setup = timeIt([&]() {
+            nested.assign(rows, vector<int>(cols));
+            generateNestedMatrix(nested, rows, cols, seed);
+        });
 
-        auto start_single = chrono::high_resolution_clock::now();
-        int result_single = findMaxOfMins(matrix, rows, cols, 1);
-        auto end_single = chrono::high_resolution_clock::now();
-        chrono::duration<double> single_thread_time = end_single - start_single;
+        Matrix<int> matrix;
+        double contiguous_setup = timeIt([&]() {
+            matrix = Matrix<int>(rows, cols);
+            generateMatrix(matrix, rows, cols, seed);
+        });
 
-        cout << rows << "x" << cols << "   | " << 1
-            << "       | " << single_thread_time.count()
-            << "             | " << 1
-            << "         | " << result_single
-            << endl;
+        cout << rows << "x" << cols << " setup: vector<vector> " << nested_setup
+            << " s, Matrix " << contiguous_setup << " s" << endl;
+        cout << "Matrix Size | Threads | Nested Time (s) | Contiguous Time (s) | Layout Gain | Speedup | Max of Min" << endl;
 
-        for (int threads : thread_counts) {
-            if (threads == 1) continue; 
+        double single_thread_time = 0.0;
 
-            auto start = chrono::high_resolution_clock::now();
-            int result = findMaxOfMins(matrix, rows, cols, threads);
-            auto end = chrono::high_resolution_clock::now();
-            chrono::duration<double> execution_time = end - start;
+        for (int threads : thread_counts) {
+            int result_nested = 0, result = 0;
+            double nested_time = timeIt([&]() { result_nested = findMaxOfMinsNested(nested, rows, cols, threads); }, 3);
+            double execution_time = timeIt([&]() { result = findMaxOfMins(matrix, threads); }, 3);
 
-            double speedup = single_thread_time.count() / execution_time.count();
+            if (threads == 1) {
+                single_thread_time = execution_time;
+            }
 
             cout << rows << "x" << cols << "   | " << threads
-                << "       | " << execution_time.count()
-                << "             | " << speedup
-                << "         | " << result
+                << "       | " << nested_time
+                << "       | " << execution_time
+                << "       | " << nested_time / execution_time
+                << "       | " << single_thread_time / execution_time
+                << "       | " << result
+                << (result == result_nested ? "" : " (MISMATCH)")
                 << endl;
         }
     }
@@ -3,12 +3,18 @@
 #include <omp.h>
 #include <random>
 #include <chrono>
+#include <algorithm>
 
-// A function for heavy calculations
-int heavy_computation(int value) {
+#include "rng.hpp"
+#include "work_stealing.hpp"
+#include "autotune.hpp"
+
+// A function for heavy calculations. Each thread draws from its own generator;
+// rand() would serialize the heavy iterations on glibc's global lock.
+int heavy_computation(int value, rng::Xoshiro256ss& generator) {
     int result = value;
-    for (int i = 0; i < 10000; ++i) { 
-        result += rand() % 1000;
+    for (int i = 0; i < 10000; ++i) {
+        result += rng::uniform_int(generator, 0, 999);
     }
     return result;
 }
@@ -18,62 +24,150 @@ int light_computation(int value) {
     return value + 1; 
 }
 
-// Diffirent distribution
-void run_experiment(const std::string& dist, int num_iterations, int num_threads) {
-    std::vector<int> data(num_iterations);
+// The time of one run and what every thread did in it
+struct Result {
+    double seconds = 0.0;
+    std::vector<work_stealing::ThreadStats> threads;
+};
 
-    std::default_random_engine generator;
-    std::uniform_int_distribution<int> distribution_range(0, 1000);
-    for (int i = 0; i < num_iterations; ++i) {
-        data[i] = distribution_range(generator);
+// Every tenth iteration is a heavy operation, the rest are easy
+void iteration(std::vector<int>& data, int i, rng::PerThread<rng::Xoshiro256ss>& generators) {
+    if (i % 10 == 0) {
+        data[i] = heavy_computation(data[i], generators.local());
+    }
+    else {
+        data[i] = light_computation(data[i]);
     }
+}
 
-    omp_set_num_threads(num_threads);
+// Diffirent distribution. "stealing" is the work-stealing loop, with chunk as
+// its grain; the others are omp_set_schedule kinds, chunk 0 is their default.
+Result run_experiment(const std::string& dist, int chunk, int num_iterations, int num_threads) {
+    std::vector<int> data = rng::uniform_ints(num_iterations, 0, 1000, 42);
+    rng::PerThread<rng::Xoshiro256ss> generators(42, num_threads);
+    Result result;
 
-    if (dist == "static") {
-        omp_set_schedule(omp_sched_static, 0);
-    }
-    else if (dist == "dynamic") {
-        omp_set_schedule(omp_sched_dynamic, 0);
-    }
-    else if (dist == "guided") {
-        omp_set_schedule(omp_sched_guided, 0);
-    }
+    omp_set_num_threads(num_threads);
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    #pragma omp parallel for
-    for (int i = 0; i < num_iterations; ++i) {
-        if (i % 10 == 0) {
-            // Every tenth iteration is a heavy operation.
-            data[i] = heavy_computation(data[i]);
+    if (dist == "stealing") {
+        result.threads = work_stealing::parallel_for(0, num_iterations, chunk, num_threads,
+            [&](long long i) { iteration(data, static_cast<int>(i), generators); });
+    }
+    else {
+        if (dist == "static") {
+            omp_set_schedule(omp_sched_static, chunk);
+        }
+        else if (dist == "dynamic") {
+            omp_set_schedule(omp_sched_dynamic, chunk);
         }
-        else {
-            // Easy operation on the remaining iterations
-            data[i] = light_computation(data[i]);
+        else if (dist == "guided") {
+            omp_set_schedule(omp_sched_guided, chunk);
+        }
+
+        // Busy is the time a thread spends in the loop, idle its wait for the slowest thread
+        result.threads.resize(num_threads);
+        #pragma omp parallel
+        {
+            auto begin = std::chrono::high_resolution_clock::now();
+            work_stealing::ThreadStats local;
+
+            #pragma omp for schedule(runtime) nowait
+            for (int i = 0; i < num_iterations; ++i) {
+                iteration(data, i, generators);
+                local.iterations += 1;
+            }
+
+            auto finish = std::chrono::high_resolution_clock::now();
+            #pragma omp barrier
+            auto last = std::chrono::high_resolution_clock::now();
+            local.busy = std::chrono::duration<double>(finish - begin).count();
+            local.idle = std::chrono::duration<double>(last - finish).count();
+            result.threads[omp_get_thread_num()] = local;
         }
     }
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
+    result.seconds = duration.count();
+    return result;
+}
+
+// Slowest thread's busy time over the mean busy time; 1 is a perfect balance
+double imbalance(const Result& result) {
+    double longest = 0.0, total = 0.0;
+    for (const work_stealing::ThreadStats& t : result.threads) {
+        longest = std::max(longest, t.busy);
+        total += t.busy;
+    }
+    return total > 0 ? longest * result.threads.size() / total : 1.0;
+}
+
+void print_summary(const Result& result, const std::string& dist, int chunk, int num_iterations, int num_threads) {
+    double idle = 0.0;
+    long long steals = 0;
+    for (const work_stealing::ThreadStats& t : result.threads) {
+        idle += t.idle;
+        steals += t.steals;
+    }
+    std::cout << num_iterations << ", " << num_threads << ", " << chunk << ", " << result.seconds << ", " << dist
+        << ", " << imbalance(result) << ", " << idle << ", " << steals << std::endl;
+}
+
+// The run_experiment distribution, chunk and thread count (at most num_threads) the
+// autotuner found fastest for num_iterations; tuned on the first run on a host, then cached
+autotune::Schedule tuned_schedule(const std::vector<std::string>& distributions, const std::vector<int>& chunks,
+                                  int num_iterations, int num_threads) {
+    return autotune::tune("OpenMP_6", num_iterations, num_threads,
+        [&](const autotune::Schedule& s) { run_experiment(s.kind, s.chunk, num_iterations, s.threads); },
+        autotune::candidates(num_threads, distributions, chunks));
+}
 
-    std::cout << num_iterations << ", " << num_threads << ", " << duration.count() << ", " << dist << std::endl;
+void print_threads(const Result& result) {
+    for (size_t t = 0; t < result.threads.size(); ++t) {
+        const work_stealing::ThreadStats& s = result.threads[t];
+        std::cout << "  " << t << ", " << s.busy << ", " << s.idle << ", " << s.iterations
+            << ", " << s.steals << ", " << s.failed_steals << std::endl;
+    }
 }
 
-int main() {
-    std::cout << "Iterations | Threads | Execution Time (s) | Distribution" << std::endl;
+int main(int argc, char* argv[]) {
+    // --retune ignores the autotuner cache and tunes the "auto" rows again
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--retune") autotune::set_retune(true);
+    }
+
+    std::cout << "Iterations | Threads | Chunk | Execution Time (s) | Distribution | Imbalance (max/mean busy) | Idle (thread-s) | Steals" << std::endl;
 
     std::vector<int> iterations = { 100, 1000, 10000 };
 
-    std::vector<std::string> distributions = { "static", "dynamic", "guided" };
+    std::vector<std::string> distributions = { "static", "dynamic", "guided", "stealing" };
+
+    std::vector<int> chunks = { 0, 1, 4, 16, 64 };
 
     for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
         for (int num_iterations : iterations) {
             for (const std::string& dist : distributions) {
-                run_experiment(dist, num_iterations, num_threads);
+                for (int chunk : chunks) {
+                    Result result = run_experiment(dist, chunk, num_iterations, num_threads);
+                    print_summary(result, dist, chunk, num_iterations, num_threads);
+                }
             }
+
+            autotune::Schedule best = tuned_schedule(distributions, chunks, num_iterations, num_threads);
+            Result result = run_experiment(best.kind, best.chunk, num_iterations, best.threads);
+            print_summary(result, "auto (" + autotune::to_string(best) + ")", best.chunk, num_iterations, num_threads);
         }
     }
 
+    // Where the time goes in the largest configuration
+    const int num_iterations = iterations.back(), num_threads = 8;
+    for (const std::string& dist : distributions) {
+        std::cout << std::endl << dist << ", " << num_iterations << " iterations, " << num_threads << " threads" << std::endl;
+        std::cout << "  Thread | Busy (s) | Idle (s) | Iterations | Steals | Failed steals" << std::endl;
+        print_threads(run_experiment(dist, 0, num_iterations, num_threads));
+    }
+
     return 0;
 }
@@ -3,6 +3,12 @@
 #include <omp.h>
 #include <chrono>
 #include <mutex>
+#include <numeric>
+#include <string>
+
+#include "rng.hpp"
+#include "summation.hpp"
+#include "scan.hpp"
 
 std::mutex mtx;
 
@@ -52,45 +58,85 @@ double sum_reduction(const std::vector<int>& data) {
     return sum;
 }
 
+// Times one summation, checks it against the exact sum and reports elements per second
+template <typename Sum>
+void time_sum(const std::string& name, Sum sum, const std::vector<int>& data, int num_threads, long long exact) {
+    auto start = std::chrono::high_resolution_clock::now();
+    double result = sum(data);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << data.size() << ", " << num_threads << ", " << name << ", " << duration.count() << "s, "
+        << data.size() / duration.count() << " elements/s" << (result == static_cast<double>(exact) ? "" : ", MISMATCH") << std::endl;
+}
+
 void run_experiment(const std::vector<int>& data, int num_threads) {
     omp_set_num_threads(num_threads);
 
+    // Every partial sum is an integer below 2^53, so each variant must be exact
+    long long exact = std::accumulate(data.begin(), data.end(), 0LL);
+
+    time_sum("Atomic", sum_atomic, data, num_threads, exact);
+    time_sum("Critical", sum_critical, data, num_threads, exact);
+    time_sum("Lock", sum_lock, data, num_threads, exact);
+    time_sum("OpenMP reduction", sum_reduction, data, num_threads, exact);
+
+    auto view = [](double (*sum)(const int*, size_t)) {
+        return [sum](const std::vector<int>& data) { return sum(data.data(), data.size()); };
+    };
+    time_sum("Padded per-thread", view(summation::padded<int>), data, num_threads, exact);
+    time_sum("Unpadded per-thread (false sharing)", view(summation::false_sharing<int>), data, num_threads, exact);
+    time_sum("Tree combine", view(summation::tree<int>), data, num_threads, exact);
+    time_sum("Relaxed atomic<double> partials", view(summation::atomic<int>), data, num_threads, exact);
+    time_sum("SIMD multi-accumulator", view(summation::simd<int>), data, num_threads, exact);
+}
+
+// Times one scan of data into out, checks it against the reference and reports GB/s
+// of the minimum traffic: the input read once, the output written once
+template <typename Scan>
+void time_scan(const std::string& name, Scan scan, const std::vector<int>& data, std::vector<long long>& out,
+               const std::vector<long long>& reference, int num_threads) {
     auto start = std::chrono::high_resolution_clock::now();
-    double result_atomic = sum_atomic(data);
+    scan(data.data(), out.data(), data.size());
     auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration_atomic = end - start;
-    std::cout << data.size() << ", " << num_threads << ", Atomic, " << duration_atomic.count() << "s" << std::endl;
-
-    start = std::chrono::high_resolution_clock::now();
-    double result_critical = sum_critical(data);
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration_critical = end - start;
-    std::cout << data.size() << ", " << num_threads << ", Critical, " << duration_critical.count() << "s" << std::endl;
-
-    start = std::chrono::high_resolution_clock::now();
-    double result_lock = sum_lock(data);
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration_lock = end - start;
-    std::cout << data.size() << ", " << num_threads << ", Lock, " << duration_lock.count() << "s" << std::endl;
-
-    start = std::chrono::high_resolution_clock::now();
-    double result_reduction = sum_reduction(data);
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration_reduction = end - start;
-    std::cout << data.size() << ", " << num_threads << ", OpenMP reduction, " << duration_reduction.count() << "s" << std::endl;
+    std::chrono::duration<double> duration = end - start;
+    double bytes = static_cast<double>(data.size()) * (sizeof(int) + sizeof(long long));
+    std::cout << data.size() << ", " << num_threads << ", " << name << ", " << duration.count() << "s, "
+        << bytes / duration.count() / 1e9 << " GB/s" << (out == reference ? "" : ", MISMATCH") << std::endl;
+}
+
+void run_scan_experiment(const std::vector<int>& data, int num_threads) {
+    omp_set_num_threads(num_threads);
+
+    std::vector<long long> inclusive(data.size()), exclusive(data.size()), out(data.size());
+    std::inclusive_scan(data.begin(), data.end(), inclusive.begin(), std::plus<long long>(), 0LL);
+    std::exclusive_scan(data.begin(), data.end(), exclusive.begin(), 0LL);
+
+    using Out = long long;
+    time_scan("Inclusive scan, two-pass blocked",
+        [](const int* in, Out* o, size_t n) { scan::blocked(in, o, n, scan::INCLUSIVE, Out()); }, data, out, inclusive, num_threads);
+    time_scan("Inclusive scan, decoupled lookback",
+        [](const int* in, Out* o, size_t n) { scan::lookback(in, o, n, scan::INCLUSIVE, Out()); }, data, out, inclusive, num_threads);
+    time_scan("Inclusive scan, SIMD blocked",
+        [](const int* in, Out* o, size_t n) { scan::simd(in, o, n, scan::INCLUSIVE, Out()); }, data, out, inclusive, num_threads);
+    time_scan("Exclusive scan, two-pass blocked",
+        [](const int* in, Out* o, size_t n) { scan::blocked(in, o, n, scan::EXCLUSIVE, Out()); }, data, out, exclusive, num_threads);
+    time_scan("Exclusive scan, decoupled lookback",
+        [](const int* in, Out* o, size_t n) { scan::lookback(in, o, n, scan::EXCLUSIVE, Out()); }, data, out, exclusive, num_threads);
+    time_scan("Exclusive scan, SIMD blocked",
+        [](const int* in, Out* o, size_t n) { scan::simd(in, o, n, scan::EXCLUSIVE, Out()); }, data, out, exclusive, num_threads);
 }
 
 int main() {
+    std::cout << "Size, Threads, Method, Time, Throughput" << std::endl;
+
     std::vector<size_t> sizes = { 100000, 1000000, 10000000, 50000000 }; 
 
     for (size_t size : sizes) {
-        std::vector<int> data(size);
-        for (size_t i = 0; i < size; ++i) {
-            data[i] = rand() % 100;
-        }
+        std::vector<int> data = rng::uniform_ints(size, 0, 99, 42);
 
         for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
             run_experiment(data, num_threads);
+            run_scan_experiment(data, num_threads);
         }
     }
 
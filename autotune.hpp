@@ -0,0 +1,209 @@
+#pragma once
+
+// Loop schedule autotuner with an on-disk cache.
+//
+// tune() times every candidate (schedule kind, chunk, thread count) of a
+// kernel at one problem size and returns the fastest. The winner is written
+// to a small text file keyed by host, kernel, problem size and the largest
+// thread count allowed. Later runs on the same host read it back and do not
+// tune again. One line per entry:
+//   host kernel size max_threads kind chunk threads seconds
+// The file is autotune.cache in the working directory, or $AUTOTUNE_CACHE.
+// set_retune(true) (or AUTOTUNE_RETUNE=1) ignores the file and tunes every
+// key again, once per process.
+//
+// A candidate's kind is normally an omp_set_schedule kind; apply() installs it
+// for a schedule(runtime) loop. A caller can also add kinds it runs itself.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+#include <unistd.h>
+
+namespace autotune {
+
+struct Schedule {
+    std::string kind = "static";   // "static", "dynamic", "guided", or a kind the caller runs itself
+    int chunk = 0;                 // 0 is the default chunk of the kind
+    int threads = 1;
+};
+
+inline std::string to_string(const Schedule& s) {
+    return s.kind + "/" + std::to_string(s.chunk) + "/" + std::to_string(s.threads);
+}
+
+// Installs an OpenMP schedule kind for loops with schedule(runtime)
+inline void apply(const Schedule& s) {
+    if (s.kind == "dynamic") {
+        omp_set_schedule(omp_sched_dynamic, s.chunk);
+    }
+    else if (s.kind == "guided") {
+        omp_set_schedule(omp_sched_guided, s.chunk);
+    }
+    else {
+        omp_set_schedule(omp_sched_static, s.chunk);
+    }
+}
+
+// Every kind x chunk at 1, 2, 4, ... threads up to max_threads
+inline std::vector<Schedule> candidates(int max_threads,
+                                        const std::vector<std::string>& kinds = { "static", "dynamic", "guided" },
+                                        const std::vector<int>& chunks = { 0, 16, 64 }) {
+    std::vector<int> threads;
+    for (int t = 1; t < max_threads; t *= 2) {
+        threads.push_back(t);
+    }
+    threads.push_back(std::max(max_threads, 1));
+
+    std::vector<Schedule> result;
+    for (int t : threads) {
+        for (const std::string& kind : kinds) {
+            for (int chunk : chunks) {
+                result.push_back(Schedule{ kind, chunk, t });
+            }
+        }
+    }
+    return result;
+}
+
+inline std::string host_name() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') {
+        return "unknown";
+    }
+    return name;
+}
+
+class Cache {
+public:
+    struct Entry {
+        Schedule schedule;
+        double seconds = 0.0;
+    };
+
+    explicit Cache(const std::string& path) : path_(path), host_(host_name()) {
+        std::ifstream in(path_);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string host, kernel;
+            long long size;
+            int max_threads;
+            Entry e;
+            if (fields >> host >> kernel >> size >> max_threads >> e.schedule.kind >> e.schedule.chunk >> e.schedule.threads >> e.seconds) {
+                entries_[key(host, kernel, size, max_threads)] = e;
+            }
+        }
+    }
+
+    bool find(const std::string& kernel, long long size, int max_threads, Entry& e) const {
+        auto it = entries_.find(key(host_, kernel, size, max_threads));
+        if (it == entries_.end()) return false;
+        e = it->second;
+        return true;
+    }
+
+    // Records an entry and rewrites the file; entries of other hosts are kept
+    void store(const std::string& kernel, long long size, int max_threads, const Entry& e) {
+        entries_[key(host_, kernel, size, max_threads)] = e;
+
+        std::string temporary = path_ + ".tmp";
+        {
+            std::ofstream out(temporary);
+            for (const auto& item : entries_) {
+                const Schedule& s = item.second.schedule;
+                out << item.first << " " << s.kind << " " << s.chunk << " " << s.threads << " " << item.second.seconds << "\n";
+            }
+            if (!out) return;
+        }
+        std::rename(temporary.c_str(), path_.c_str());   // Readers never see a half-written file
+    }
+
+private:
+    static std::string key(const std::string& host, const std::string& kernel, long long size, int max_threads) {
+        return host + " " + kernel + " " + std::to_string(size) + " " + std::to_string(max_threads);
+    }
+
+    std::string path_;
+    std::string host_;
+    std::map<std::string, Entry> entries_;
+};
+
+struct State {
+    bool retune = false;
+    std::set<std::string> retuned;   // Keys already tuned again by this process
+};
+
+inline State& state() {
+    static State s = [] {
+        State init;
+        const char* env = std::getenv("AUTOTUNE_RETUNE");
+        init.retune = env != nullptr && std::string(env) != "0";
+        return init;
+    }();
+    return s;
+}
+
+inline Cache& cache() {
+    static Cache c([] {
+        const char* env = std::getenv("AUTOTUNE_CACHE");
+        return std::string(env != nullptr && env[0] != '\0' ? env : "autotune.cache");
+    }());
+    return c;
+}
+
+// Tune every key again instead of reading the cache
+inline void set_retune(bool retune) {
+    state().retune = retune;
+}
+
+// The fastest candidate for `kernel` at `size` with at most max_threads threads.
+// run(schedule) executes the kernel once; each candidate is timed as the best of
+// `repetitions` runs. Cached results are returned without running anything.
+template <typename Run>
+Schedule tune(const std::string& kernel, long long size, int max_threads, Run run,
+              const std::vector<Schedule>& choices, int repetitions = 2) {
+    Cache::Entry cached;
+    std::string id = kernel + " " + std::to_string(size) + " " + std::to_string(max_threads);
+    bool retune = state().retune && state().retuned.count(id) == 0;
+    if (!retune && cache().find(kernel, size, max_threads, cached)) {
+        return cached.schedule;
+    }
+
+    Cache::Entry best;
+    best.seconds = -1.0;
+    for (const Schedule& s : choices) {
+        double seconds = 0.0;
+        for (int r = 0; r < repetitions; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            run(s);
+            auto end = std::chrono::high_resolution_clock::now();
+            double t = std::chrono::duration<double>(end - start).count();
+            seconds = r == 0 ? t : std::min(seconds, t);
+        }
+        if (best.seconds < 0 || seconds < best.seconds) {
+            best.schedule = s;
+            best.seconds = seconds;
+        }
+    }
+
+    cache().store(kernel, size, max_threads, best);
+    state().retuned.insert(id);
+    return best.schedule;
+}
+
+template <typename Run>
+Schedule tune(const std::string& kernel, long long size, int max_threads, Run run) {
+    return tune(kernel, size, max_threads, run, candidates(max_threads));
+}
+
+} // namespace autotune
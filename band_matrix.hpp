@@ -0,0 +1,92 @@
+#pragma once
+
+// Square band matrix with k sub- and k super-diagonals in LAPACK general band
+// storage: a (2k+1) x n array ab with a(i, j) = ab(k + i - j, j).
+//
+// Row d of ab is one diagonal of the matrix, so the kernels below walk the
+// diagonals with unit stride and touch only the (2k+1) * n stored values.
+// Entries outside the band are zero and are never stored or read; the row
+// minimum accounts for them from the row's extent alone. The corners of ab
+// that fall outside the matrix are unused.
+
+#include <algorithm>
+#include <limits>
+
+#include "matrix.hpp"
+
+namespace band {
+
+template <typename T>
+class BandMatrix {
+public:
+    BandMatrix() = default;
+    BandMatrix(int n, int k) : n_(n), k_(k), ab_(2 * k + 1, n, T()) {}
+
+    int n() const { return n_; }
+    int k() const { return k_; }
+
+    bool in_band(int i, int j) const { return j >= i - k_ && j <= i + k_; }
+
+    // a(i, j); zero outside the band
+    T get(int i, int j) const { return in_band(i, j) ? ab_(k_ + i - j, j) : T(); }
+    // Only valid for (i, j) inside the band
+    T& at(int i, int j) { return ab_(k_ + i - j, j); }
+
+    // Diagonal d of ab: element j holds a(j + d - k, j)
+    const T* diagonal(int d) const { return ab_.row_data(d); }
+
+    // First and one-past-last row i that has an element on diagonal d
+    int first_row(int d) const { return std::max(0, d - k_); }
+    int last_row(int d) const { return std::min(n_, n_ + d - k_); }
+
+    size_t bytes() const { return ab_.bytes(); }
+
+private:
+    int n_ = 0;
+    int k_ = 0;
+    matrix::Matrix<T> ab_;
+};
+
+// Minimum of each row i in [first, last) into out[i - first], implicit zeros included.
+// The block is swept diagonal by diagonal so every inner loop is unit stride.
+template <typename T>
+void row_mins(const BandMatrix<T>& a, int first, int last, T* out) {
+    const int n = a.n(), k = a.k();
+    for (int i = first; i < last; ++i) {
+        // Row i stores columns max(0, i - k) .. min(n - 1, i + k); any other column is a zero
+        int stored = std::min(n - 1, i + k) - std::max(0, i - k) + 1;
+        out[i - first] = stored < n ? T() : std::numeric_limits<T>::max();
+    }
+
+    for (int d = 0; d <= 2 * k; ++d) {
+        const T* diag = a.diagonal(d);   // diag[i + k - d] = a(i, i + k - d)
+        const int shift = k - d;
+        int lo = std::max(first, a.first_row(d));
+        int hi = std::min(last, a.last_row(d));
+        #pragma omp simd
+        for (int i = lo; i < hi; ++i) {
+            T value = diag[i + shift];
+            out[i - first] = value < out[i - first] ? value : out[i - first];
+        }
+    }
+}
+
+// y[i] = sum_j a(i, j) * x[j] for rows i in [first, last)
+template <typename T, typename U>
+void matvec(const BandMatrix<T>& a, const U* x, U* y, int first, int last) {
+    const int k = a.k();
+    std::fill(y + first, y + last, U());
+
+    for (int d = 0; d <= 2 * k; ++d) {
+        const T* diag = a.diagonal(d);
+        const int shift = k - d;         // row i meets diagonal d in column i + shift
+        int lo = std::max(first, a.first_row(d));
+        int hi = std::min(last, a.last_row(d));
+        #pragma omp simd
+        for (int i = lo; i < hi; ++i) {
+            y[i] += static_cast<U>(diag[i + shift]) * x[i + shift];
+        }
+    }
+}
+
+} // namespace band
@@ -0,0 +1,88 @@
+#pragma once
+
+// Batched distributed dot products.
+//
+// Each rank holds its block of `pairs` vector pairs, stored row-major
+// (pair k is a[k * n .. k * n + n) and b[k * n .. k * n + n)). The pairs are
+// processed in batches: the local partials of a whole batch are computed in
+// one pass and then combined with a single vector allreduce, instead of one
+// collective per scalar.
+//
+// With overlap enabled the allreduce of batch k is an MPI_Iallreduce that
+// stays in flight while the partials of batch k + 1 are computed; the
+// compute loop calls MPI_Test between pairs so the collective keeps
+// progressing without an asynchronous progress thread.
+
+#include <mpi.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace batched_dot {
+
+// Integer data is accumulated in 64 bits, floating point data in double
+template <typename T>
+using acc_t = typename std::conditional<std::is_integral<T>::value, long long, double>::type;
+
+template <typename A> MPI_Datatype mpi_type();
+template <> inline MPI_Datatype mpi_type<long long>() { return MPI_LONG_LONG; }
+template <> inline MPI_Datatype mpi_type<double>() { return MPI_DOUBLE; }
+
+template <typename T>
+acc_t<T> dot(const T* a, const T* b, int n) {
+    acc_t<T> sum = 0;
+    #pragma omp simd reduction(+:sum)
+    for (int i = 0; i < n; ++i) {
+        sum += static_cast<acc_t<T>>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+// Partials of pairs [0, count). If `pending` is an active request it is
+// tested after every pair so an outstanding collective can progress.
+template <typename T>
+void local_partials(const T* a, const T* b, int count, int n, acc_t<T>* out, MPI_Request* pending = nullptr) {
+    for (int k = 0; k < count; ++k) {
+        out[k] = dot(a + static_cast<size_t>(k) * n, b + static_cast<size_t>(k) * n, n);
+        if (pending && *pending != MPI_REQUEST_NULL) {
+            int done;
+            MPI_Test(pending, &done, MPI_STATUS_IGNORE);
+        }
+    }
+}
+
+// results[k] = global dot product of pair k, on every rank of comm.
+// Returns the number of collectives issued.
+template <typename T>
+int dot_batched(const T* a, const T* b, int pairs, int n, int batch, acc_t<T>* results,
+                MPI_Comm comm, bool overlap) {
+    using A = acc_t<T>;
+    batch = std::max(1, std::min(batch, pairs));
+
+    // Two partial buffers: one being filled, one owned by the collective in flight
+    std::vector<A> partials[2] = { std::vector<A>(batch), std::vector<A>(batch) };
+    MPI_Request request = MPI_REQUEST_NULL;
+
+    int collectives = 0;
+    for (int first = 0; first < pairs; first += batch) {
+        int count = std::min(batch, pairs - first);
+        std::vector<A>& buffer = partials[collectives % 2];
+        const size_t offset = static_cast<size_t>(first) * n;
+
+        if (overlap) {
+            local_partials(a + offset, b + offset, count, n, buffer.data(), &request);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+            MPI_Iallreduce(buffer.data(), results + first, count, mpi_type<A>(), MPI_SUM, comm, &request);
+        }
+        else {
+            local_partials(a + offset, b + offset, count, n, buffer.data());
+            MPI_Allreduce(buffer.data(), results + first, count, mpi_type<A>(), MPI_SUM, comm);
+        }
+        ++collectives;
+    }
+
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    return collectives;
+}
+
+} // namespace batched_dot
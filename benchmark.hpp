@@ -0,0 +1,295 @@
+#pragma once
+
+// Header-only benchmark harness shared by the OpenMP and MPI programs.
+//
+// A kernel is registered with a name, the sizes / thread counts / rank counts
+// it should be swept over, and a prepare function. The prepare function does
+// the untimed setup (data generation, distribution) for one configuration and
+// returns the body that is actually timed. Every configuration gets a few
+// warmup runs and then a number of timed samples that are summarised as
+// min / median / mean / stddev / percentiles.
+//
+// MPI is not required here: distributed kernels pass a Timing with a sync hook
+// (usually a barrier) and a combine hook (usually a max-allreduce of the
+// sample) so that every sample is the time of the slowest rank.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// One point of the sweep
+struct Params {
+    long long size = 0;
+    int threads = 1;
+    int ranks = 1;
+};
+
+struct Stats {
+    int samples = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double median = 0.0;
+    double stddev = 0.0;
+    double p10 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+};
+
+using Body = std::function<double()>;                 // timed region, returns a checksum
+using Prepare = std::function<Body(const Params&)>;   // untimed setup for one configuration
+
+struct Kernel {
+    std::string name;
+    std::string program;                 // the program the kernel comes from, e.g. "OpenMP_2"
+    std::vector<long long> sizes;
+    std::vector<int> threads = { 1 };
+    std::vector<int> ranks = { 1 };
+    Prepare prepare;
+};
+
+struct Result {
+    std::string kernel;
+    Params params;
+    Stats stats;
+    double checksum = 0.0;
+};
+
+// Hooks used around every timed sample
+struct Timing {
+    std::function<void()> sync;              // called before the clock starts
+    std::function<double(double)> combine;   // turns a local sample into the reported one
+};
+
+struct Options {
+    int warmup = 2;
+    int repetitions = 10;
+};
+
+// Linear interpolation between the closest ranks of an already sorted vector
+inline double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    double pos = q * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    double frac = pos - lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+inline Stats compute_stats(std::vector<double> samples) {
+    Stats s;
+    s.samples = static_cast<int>(samples.size());
+    if (samples.empty()) return s;
+
+    std::sort(samples.begin(), samples.end());
+    s.min = samples.front();
+    s.max = samples.back();
+
+    double sum = 0.0;
+    for (double x : samples) sum += x;
+    s.mean = sum / samples.size();
+
+    double sq = 0.0;
+    for (double x : samples) sq += (x - s.mean) * (x - s.mean);
+    s.stddev = samples.size() > 1 ? std::sqrt(sq / (samples.size() - 1)) : 0.0;
+
+    s.median = percentile(samples, 0.5);
+    s.p10 = percentile(samples, 0.1);
+    s.p90 = percentile(samples, 0.9);
+    s.p99 = percentile(samples, 0.99);
+    return s;
+}
+
+// Monotonic wall clock in seconds
+inline double now() {
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+// Runs one configuration of a kernel: warmup first, then the timed samples
+inline Result run(const Kernel& kernel, const Params& params, const Options& options, const Timing& timing = {}) {
+    Body body = kernel.prepare(params);
+
+    Result result;
+    result.kernel = kernel.name;
+    result.params = params;
+
+    for (int i = 0; i < options.warmup; ++i) {
+        if (timing.sync) timing.sync();
+        result.checksum = body();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options.repetitions);
+    for (int i = 0; i < options.repetitions; ++i) {
+        if (timing.sync) timing.sync();
+        double start = now();
+        result.checksum = body();
+        double elapsed = now() - start;
+        samples.push_back(timing.combine ? timing.combine(elapsed) : elapsed);
+    }
+
+    result.stats = compute_stats(samples);
+    return result;
+}
+
+// Global list of kernels, filled by Registrar objects at static-init time
+inline std::vector<Kernel>& registry() {
+    static std::vector<Kernel> kernels;
+    return kernels;
+}
+
+struct Registrar {
+    explicit Registrar(Kernel kernel) { registry().push_back(std::move(kernel)); }
+};
+
+// Command line selection of kernels and sweep points. Empty lists match everything.
+struct Filter {
+    std::vector<std::string> names;   // substrings of the kernel name
+    std::vector<long long> sizes;
+    std::vector<int> threads;
+    std::vector<int> ranks;
+
+    bool match_name(const std::string& name) const {
+        if (names.empty()) return true;
+        for (const std::string& n : names) {
+            if (name.find(n) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    template <typename T>
+    static bool contains(const std::vector<T>& list, T value) {
+        return list.empty() || std::find(list.begin(), list.end(), value) != list.end();
+    }
+
+    bool match(const Params& p) const {
+        return contains(sizes, p.size) && contains(threads, p.threads) && contains(ranks, p.ranks);
+    }
+};
+
+// Every sweep point of a kernel that passes the filter
+inline std::vector<Params> expand(const Kernel& kernel, const Filter& filter) {
+    std::vector<Params> points;
+    for (int r : kernel.ranks) {
+        for (int t : kernel.threads) {
+            for (long long n : kernel.sizes) {
+                Params p;
+                p.size = n;
+                p.threads = t;
+                p.ranks = r;
+                if (filter.match(p)) points.push_back(p);
+            }
+        }
+    }
+    return points;
+}
+
+// Splits "a,b,c" into its parts
+inline std::vector<std::string> split(const std::string& text, char sep = ',') {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) parts.push_back(item);
+    }
+    return parts;
+}
+
+// ---- Output ----------------------------------------------------------------
+
+enum class Format { Table, Csv, Json };
+
+inline bool parse_format(const std::string& text, Format& format) {
+    if (text == "table") format = Format::Table;
+    else if (text == "csv") format = Format::Csv;
+    else if (text == "json") format = Format::Json;
+    else return false;
+    return true;
+}
+
+// Streams results as they are produced, so long sweeps show progress
+class Reporter {
+public:
+    Reporter(std::ostream& out, Format format) : out_(out), format_(format) {}
+
+    void begin() {
+        if (format_ == Format::Table) {
+            out_ << std::left << std::setw(28) << "Kernel" << std::right
+                << std::setw(12) << "Size" << std::setw(8) << "Threads" << std::setw(6) << "Ranks"
+                << std::setw(13) << "Median (s)" << std::setw(13) << "Min (s)"
+                << std::setw(13) << "Stddev (s)" << std::setw(13) << "P90 (s)"
+                << std::setw(9) << "Speedup" << std::setw(16) << "Checksum" << "\n";
+        }
+        else if (format_ == Format::Csv) {
+            out_ << "kernel,size,threads,ranks,samples,min,median,mean,stddev,p10,p90,p99,max,speedup,checksum\n";
+        }
+        else {
+            out_ << "[";
+        }
+    }
+
+    // Speedup is relative to the first reported point with the same kernel and size
+    void add(const Result& r) {
+        double speedup = 1.0;
+        bool found = false;
+        for (const Result& b : baselines_) {
+            if (b.kernel == r.kernel && b.params.size == r.params.size) {
+                speedup = r.stats.median > 0 ? b.stats.median / r.stats.median : 0.0;
+                found = true;
+                break;
+            }
+        }
+        if (!found) baselines_.push_back(r);
+
+        const Stats& s = r.stats;
+        if (format_ == Format::Table) {
+            out_ << std::left << std::setw(28) << r.kernel << std::right
+                << std::setw(12) << r.params.size << std::setw(8) << r.params.threads << std::setw(6) << r.params.ranks
+                << std::scientific << std::setprecision(4)
+                << std::setw(13) << s.median << std::setw(13) << s.min
+                << std::setw(13) << s.stddev << std::setw(13) << s.p90
+                << std::fixed << std::setprecision(2) << std::setw(9) << speedup
+                << std::defaultfloat << std::setprecision(10) << std::setw(16) << r.checksum << "\n";
+        }
+        else if (format_ == Format::Csv) {
+            out_ << std::setprecision(9)
+                << r.kernel << "," << r.params.size << "," << r.params.threads << "," << r.params.ranks << ","
+                << s.samples << "," << s.min << "," << s.median << "," << s.mean << "," << s.stddev << ","
+                << s.p10 << "," << s.p90 << "," << s.p99 << "," << s.max << "," << speedup << ","
+                << r.checksum << "\n";
+        }
+        else {
+            out_ << (count_ ? ",\n " : "\n ") << std::setprecision(9)
+                << "{\"kernel\": \"" << r.kernel << "\", \"size\": " << r.params.size
+                << ", \"threads\": " << r.params.threads << ", \"ranks\": " << r.params.ranks
+                << ", \"samples\": " << s.samples << ", \"min\": " << s.min << ", \"median\": " << s.median
+                << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev << ", \"p10\": " << s.p10
+                << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max
+                << ", \"speedup\": " << speedup << ", \"checksum\": " << r.checksum << "}";
+        }
+        ++count_;
+        out_.flush();
+    }
+
+    void end() {
+        if (format_ == Format::Json) out_ << "\n]\n";
+        out_.flush();
+    }
+
+private:
+    std::ostream& out_;
+    Format format_;
+    int count_ = 0;
+    std::vector<Result> baselines_;
+};
+
+} // namespace bench
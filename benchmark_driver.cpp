@@ -0,0 +1,639 @@
+// Single driver for every kernel of the OpenMP_* and MPI_* programs.
+//
+// Build:  mpicxx -O2 -fopenmp benchmark_driver.cpp -o benchmark_driver
+// Run:    mpirun -np 8 ./benchmark_driver --filter scalar_product,mpi_dot --threads 1,4 --format csv
+//
+// OpenMP kernels run on rank 0 only; MPI kernels run on a sub-communicator
+// with the requested number of ranks. Sweep points that need more ranks than
+// were started are skipped.
+
+#include <mpi.h>
+#include <omp.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <climits>
+#include <cstdlib>
+#include <mutex>
+#include <memory>
+
+#include "benchmark.hpp"
+#include "minmax_simd.hpp"
+#include "matrix.hpp"
+#include "band_matrix.hpp"
+#include "rng.hpp"
+#include "work_stealing.hpp"
+#include "summation.hpp"
+#include "scan.hpp"
+
+using bench::Body;
+using bench::Kernel;
+using bench::Params;
+using bench::Registrar;
+
+// Communicator of the sweep point being run, used by the MPI kernels
+static MPI_Comm g_comm = MPI_COMM_WORLD;
+
+static std::vector<int> random_ints(long long size, int lo, int hi, unsigned seed = 42) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> dis(lo, hi);
+    std::vector<int> data(size);
+    for (int& x : data) x = dis(gen);
+    return data;
+}
+
+// Counts and displacements of an n-element vector split over p ranks
+static void block_partition(long long n, int p, std::vector<int>& counts, std::vector<int>& displs) {
+    counts.assign(p, static_cast<int>(n / p));
+    displs.assign(p, 0);
+    for (int i = 0; i < n % p; ++i) counts[i] += 1;
+    for (int i = 1; i < p; ++i) displs[i] = displs[i - 1] + counts[i - 1];
+}
+
+static const std::vector<int> omp_threads = { 1, 2, 4, 8 };
+
+// ---- OpenMP_1: min / max of a vector ---------------------------------------
+
+static Registrar minmax_reduction(Kernel{ "minmax_reduction", "OpenMP_1", { 1000, 10000, 100000, 1000000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = std::make_shared<std::vector<int>>(random_ints(p.size, 0, 999));
+        return [data]() {
+            const std::vector<int>& v = *data;
+            int min_value = INT_MAX;
+            int max_value = INT_MIN;
+            #pragma omp parallel for reduction(min:min_value) reduction(max:max_value)
+            for (long long i = 0; i < (long long)v.size(); i++) {
+                if (v[i] < min_value) min_value = v[i];
+                if (v[i] > max_value) max_value = v[i];
+            }
+            return double(min_value) * 1000 + max_value;
+        };
+    } });
+
+static Registrar minmax_critical(Kernel{ "minmax_critical", "OpenMP_1", { 1000, 10000, 100000, 1000000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = std::make_shared<std::vector<int>>(random_ints(p.size, 0, 999));
+        return [data]() {
+            const std::vector<int>& v = *data;
+            int min_value = INT_MAX;
+            int max_value = INT_MIN;
+            #pragma omp parallel
+            {
+                int local_min = INT_MAX;
+                int local_max = INT_MIN;
+
+                #pragma omp for
+                for (long long i = 0; i < (long long)v.size(); i++) {
+                    if (v[i] < local_min) local_min = v[i];
+                    if (v[i] > local_max) local_max = v[i];
+                }
+
+                #pragma omp critical
+                {
+                    if (local_min < min_value) min_value = local_min;
+                    if (local_max > max_value) max_value = local_max;
+                }
+            }
+            return double(min_value) * 1000 + max_value;
+        };
+    } });
+
+static Registrar minmax_simd_kernel(Kernel{ "minmax_simd", "OpenMP_1", { 1000, 10000, 100000, 1000000, 10000000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = std::make_shared<std::vector<int>>(random_ints(p.size, 0, 999));
+        return [data]() {
+            const size_t size = data->size();
+            int min_value = INT_MAX;
+            int max_value = INT_MIN;
+            #pragma omp parallel reduction(min:min_value) reduction(max:max_value)
+            {
+                size_t begin = size * omp_get_thread_num() / omp_get_num_threads();
+                size_t end = size * (omp_get_thread_num() + 1) / omp_get_num_threads();
+                minmax_simd::minmax(data->data() + begin, end - begin, min_value, max_value);
+            }
+            return double(min_value) * 1000 + max_value;
+        };
+    } });
+
+// ---- OpenMP_2: scalar product ----------------------------------------------
+
+static Registrar scalar_product(Kernel{ "scalar_product", "OpenMP_2", { 1000, 10000, 100000, 1000000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto vec1 = std::make_shared<std::vector<double>>(p.size, 1.0);
+        auto vec2 = std::make_shared<std::vector<double>>(p.size, 2.0);
+        int num_threads = p.threads;
+        return [vec1, vec2, num_threads]() {
+            double result = 0.0;
+            #pragma omp parallel for reduction(+:result) num_threads(num_threads)
+            for (size_t i = 0; i < vec1->size(); ++i) {
+                result += (*vec1)[i] * (*vec2)[i];
+            }
+            return result;
+        };
+    } });
+
+// ---- OpenMP_3: rectangle-rule integral of x^2 on [0, 1] --------------------
+
+static Registrar integral(Kernel{ "integral", "OpenMP_3", { 1000, 10000, 100000, 1000000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        long long N = p.size;
+        int num_threads = p.threads;
+        return [N, num_threads]() {
+            double a = 0.0, b = 1.0;
+            double sum = 0.0;
+            double dx = (b - a) / N;
+            #pragma omp parallel for reduction(+:sum) num_threads(num_threads)
+            for (long long i = 0; i < N; ++i) {
+                double x = a + i * dx;
+                sum += x * x * dx;
+            }
+            return sum;
+        };
+    } });
+
+// ---- OpenMP_4: maximum of the row minimums ---------------------------------
+
+static Registrar find_max_of_mins(Kernel{ "findMaxOfMins", "OpenMP_4", { 100, 1000, 5000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        int n = static_cast<int>(p.size);
+        auto matrix = std::make_shared<matrix::Matrix<int>>(n, n);
+        std::mt19937 gen(42);
+        for (int i = 0; i < n; ++i) {
+            for (int& x : matrix->row(i)) x = gen() % 1000;
+        }
+        int num_threads = p.threads;
+        return [matrix, n, num_threads]() {
+            const auto& m = *matrix;
+            int max_min = INT_MIN;
+            #pragma omp parallel for reduction(max:max_min) num_threads(num_threads)
+            for (int i = 0; i < n; ++i) {
+                max_min = std::max(max_min, matrix::row_min(m, i));
+            }
+            return double(max_min);
+        };
+    } });
+
+// ---- OpemMP_5: band matrix max of row minimums under each schedule ---------
+
+static std::shared_ptr<matrix::Matrix<int>> band_matrix(int n, int k) {
+    auto matrix = std::make_shared<matrix::Matrix<int>>(n, n, 0);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> dis(1, 100);
+    for (int i = 0; i < n; ++i) {
+        for (int j = std::max(0, i - k); j <= std::min(n - 1, i + k); ++j) {
+            (*matrix)(i, j) = dis(gen);
+        }
+    }
+    return matrix;
+}
+
+static Body max_of_min_elements(const Params& p, omp_sched_t kind) {
+    auto matrix = band_matrix(static_cast<int>(p.size), 10);
+    return [matrix, kind]() {
+        const auto& m = *matrix;
+        int n = m.rows();
+        int max_of_mins = INT_MIN;
+        omp_set_schedule(kind, 0);
+        #pragma omp parallel for schedule(runtime) reduction(max:max_of_mins)
+        for (int i = 0; i < n; ++i) {
+            max_of_mins = std::max(max_of_mins, matrix::row_min(m, i));
+        }
+        return double(max_of_mins);
+    };
+}
+
+static Registrar max_of_min_static(Kernel{ "max_of_min_elements_static", "OpemMP_5", { 100, 1000, 5000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) { return max_of_min_elements(p, omp_sched_static); } });
+static Registrar max_of_min_dynamic(Kernel{ "max_of_min_elements_dynamic", "OpemMP_5", { 100, 1000, 5000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) { return max_of_min_elements(p, omp_sched_dynamic); } });
+static Registrar max_of_min_guided(Kernel{ "max_of_min_elements_guided", "OpemMP_5", { 100, 1000, 5000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) { return max_of_min_elements(p, omp_sched_guided); } });
+
+// The same values in (2k+1) x n band storage, processed in blocks of rows
+static Registrar max_of_min_banded(Kernel{ "max_of_min_elements_banded", "OpemMP_5", { 100, 1000, 5000, 10000, 1000000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        int n = static_cast<int>(p.size), k = 10;
+        auto matrix = std::make_shared<band::BandMatrix<int>>(n, k);
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<> dis(1, 100);
+        for (int i = 0; i < n; ++i) {
+            for (int j = std::max(0, i - k); j <= std::min(n - 1, i + k); ++j) {
+                matrix->at(i, j) = dis(gen);
+            }
+        }
+        int num_threads = p.threads;
+        return [matrix, n, num_threads]() {
+            const int block = 256;
+            int max_of_mins = INT_MIN;
+            #pragma omp parallel for schedule(static) reduction(max:max_of_mins) num_threads(num_threads)
+            for (int first = 0; first < n; first += block) {
+                int mins[block];
+                int last = std::min(n, first + block);
+                band::row_mins(*matrix, first, last, mins);
+                max_of_mins = std::max(max_of_mins, *std::max_element(mins, mins + (last - first)));
+            }
+            return double(max_of_mins);
+        };
+    } });
+
+// ---- OpenMP_6: unbalanced loop (every tenth iteration is heavy) ------------
+
+static int heavy_computation(int value, rng::Xoshiro256ss& generator) {
+    int result = value;
+    for (int i = 0; i < 10000; ++i) {
+        result += rng::uniform_int(generator, 0, 999);
+    }
+    return result;
+}
+
+static Body schedule_experiment(const Params& p, omp_sched_t kind) {
+    auto initial = std::make_shared<std::vector<int>>(random_ints(p.size, 0, 1000));
+    auto data = std::make_shared<std::vector<int>>(p.size);
+    return [initial, data, kind]() {
+        std::vector<int>& d = *data;
+        d = *initial;
+        rng::PerThread<rng::Xoshiro256ss> generators(42, omp_get_max_threads());
+        omp_set_schedule(kind, 0);
+        #pragma omp parallel for schedule(runtime)
+        for (int i = 0; i < (int)d.size(); ++i) {
+            if (i % 10 == 0) d[i] = heavy_computation(d[i], generators.local());
+            else d[i] = d[i] + 1;
+        }
+        return double(d.size());
+    };
+}
+
+static Registrar schedule_static(Kernel{ "schedule_static", "OpenMP_6", { 100, 1000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) { return schedule_experiment(p, omp_sched_static); } });
+static Registrar schedule_dynamic(Kernel{ "schedule_dynamic", "OpenMP_6", { 100, 1000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) { return schedule_experiment(p, omp_sched_dynamic); } });
+static Registrar schedule_guided(Kernel{ "schedule_guided", "OpenMP_6", { 100, 1000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) { return schedule_experiment(p, omp_sched_guided); } });
+static Registrar schedule_stealing(Kernel{ "schedule_stealing", "OpenMP_6", { 100, 1000, 10000 }, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto initial = std::make_shared<std::vector<int>>(random_ints(p.size, 0, 1000));
+        auto data = std::make_shared<std::vector<int>>(p.size);
+        int threads = p.threads;
+        return [initial, data, threads]() {
+            std::vector<int>& d = *data;
+            d = *initial;
+            rng::PerThread<rng::Xoshiro256ss> generators(42, threads);
+            work_stealing::parallel_for(0, (long long)d.size(), 1, threads, [&](long long i) {
+                if (i % 10 == 0) d[i] = heavy_computation(d[i], generators.local());
+                else d[i] = d[i] + 1;
+            });
+            return double(d.size());
+        };
+    } });
+
+// ---- OpenMP_7: summation with atomic / critical / lock / reduction ---------
+
+static std::mutex mtx;
+static const std::vector<long long> sum_sizes = { 100000, 1000000, 10000000, 50000000 };
+
+static std::shared_ptr<std::vector<int>> sum_data(long long size) {
+    return std::make_shared<std::vector<int>>(random_ints(size, 0, 99));
+}
+
+static Registrar sum_atomic(Kernel{ "sum_atomic", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = sum_data(p.size);
+        return [data]() {
+            double sum = 0;
+            #pragma omp parallel for
+            for (size_t i = 0; i < data->size(); ++i) {
+                #pragma omp atomic
+                sum += (*data)[i];
+            }
+            return sum;
+        };
+    } });
+
+static Registrar sum_critical(Kernel{ "sum_critical", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = sum_data(p.size);
+        return [data]() {
+            double sum = 0;
+            #pragma omp parallel for
+            for (size_t i = 0; i < data->size(); ++i) {
+                #pragma omp critical
+                {
+                    sum += (*data)[i];
+                }
+            }
+            return sum;
+        };
+    } });
+
+static Registrar sum_lock(Kernel{ "sum_lock", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = sum_data(p.size);
+        return [data]() {
+            double sum = 0;
+            #pragma omp parallel for
+            for (size_t i = 0; i < data->size(); ++i) {
+                mtx.lock();
+                sum += (*data)[i];
+                mtx.unlock();
+            }
+            return sum;
+        };
+    } });
+
+static Registrar sum_reduction(Kernel{ "sum_reduction", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) -> Body {
+        auto data = sum_data(p.size);
+        return [data]() {
+            double sum = 0;
+            #pragma omp parallel for reduction(+:sum)
+            for (size_t i = 0; i < data->size(); ++i) {
+                sum += (*data)[i];
+            }
+            return sum;
+        };
+    } });
+
+// The contention-free strategies of summation.hpp
+static Body summation_experiment(const Params& p, double (*sum)(const int*, size_t)) {
+    auto data = sum_data(p.size);
+    return [data, sum]() { return sum(data->data(), data->size()); };
+}
+
+static Registrar sum_padded(Kernel{ "sum_padded", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return summation_experiment(p, summation::padded<int>); } });
+static Registrar sum_false_sharing(Kernel{ "sum_false_sharing", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return summation_experiment(p, summation::false_sharing<int>); } });
+static Registrar sum_tree(Kernel{ "sum_tree", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return summation_experiment(p, summation::tree<int>); } });
+static Registrar sum_atomic_partials(Kernel{ "sum_atomic_partials", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return summation_experiment(p, summation::atomic<int>); } });
+static Registrar sum_simd(Kernel{ "sum_simd", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return summation_experiment(p, summation::simd<int>); } });
+
+// Inclusive prefix sums of scan.hpp into 64-bit outputs
+static Body scan_experiment(const Params& p, void (*scan)(const int*, long long*, size_t)) {
+    auto data = sum_data(p.size);
+    auto out = std::make_shared<std::vector<long long>>(p.size);
+    return [data, out, scan]() {
+        scan(data->data(), out->data(), data->size());
+        return double(out->back());
+    };
+}
+
+static Registrar scan_blocked(Kernel{ "scan_blocked", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return scan_experiment(p, [](const int* in, long long* out, size_t n) { scan::blocked(in, out, n, scan::INCLUSIVE, 0LL); }); } });
+static Registrar scan_lookback(Kernel{ "scan_lookback", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return scan_experiment(p, [](const int* in, long long* out, size_t n) { scan::lookback(in, out, n, scan::INCLUSIVE, 0LL); }); } });
+static Registrar scan_simd(Kernel{ "scan_simd", "OpenMP_7", sum_sizes, omp_threads, { 1 },
+    [](const Params& p) { return scan_experiment(p, [](const int* in, long long* out, size_t n) { scan::simd(in, out, n, scan::INCLUSIVE, 0LL); }); } });
+
+// ---- MPI_1: distributed min / max -----------------------------------------
+
+static const std::vector<int> mpi_ranks = { 1, 2, 4, 8, 16, 32, 64 };
+
+static Registrar mpi_minmax(Kernel{ "mpi_minmax", "MPI_1", { 2000, 4000, 6000, 8000, 10000 }, { 1 }, mpi_ranks,
+    [](const Params& p) -> Body {
+        MPI_Comm comm = g_comm;
+        int rank, nprocs;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &nprocs);
+
+        auto data = std::make_shared<std::vector<int>>();
+        if (rank == 0) *data = random_ints(p.size, 1, 100);
+
+        auto counts = std::make_shared<std::vector<int>>();
+        auto displs = std::make_shared<std::vector<int>>();
+        block_partition(p.size, nprocs, *counts, *displs);
+
+        return [=]() {
+            std::vector<int> local_data((*counts)[rank]);
+            MPI_Scatterv(data->data(), counts->data(), displs->data(), MPI_INT,
+                local_data.data(), (*counts)[rank], MPI_INT, 0, comm);
+
+            int local_min = INT_MAX, local_max = INT_MIN;
+            if (!local_data.empty()) {
+                local_min = *std::min_element(local_data.begin(), local_data.end());
+                local_max = *std::max_element(local_data.begin(), local_data.end());
+            }
+
+            int global_min = 0, global_max = 0;
+            MPI_Reduce(&local_min, &global_min, 1, MPI_INT, MPI_MIN, 0, comm);
+            MPI_Reduce(&local_max, &global_max, 1, MPI_INT, MPI_MAX, 0, comm);
+            return double(global_min) * 1000 + global_max;
+        };
+    } });
+
+// ---- MPI_2: distributed dot product ---------------------------------------
+
+static Registrar mpi_dot_product(Kernel{ "mpi_dot_product", "MPI_2", { 2000, 4000, 6000, 8000, 10000 }, { 1 }, { 1, 2, 3, 4, 5, 6, 7, 8 },
+    [](const Params& p) -> Body {
+        MPI_Comm comm = g_comm;
+        int rank, nprocs;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &nprocs);
+
+        std::vector<int> counts, displs;
+        block_partition(p.size, nprocs, counts, displs);
+
+        std::vector<int> vec_a, vec_b;
+        if (rank == 0) {
+            vec_a = random_ints(p.size, 0, 9, 1);
+            vec_b = random_ints(p.size, 0, 9, 2);
+        }
+
+        auto local_a = std::make_shared<std::vector<int>>(counts[rank]);
+        auto local_b = std::make_shared<std::vector<int>>(counts[rank]);
+        MPI_Scatterv(vec_a.data(), counts.data(), displs.data(), MPI_INT, local_a->data(), counts[rank], MPI_INT, 0, comm);
+        MPI_Scatterv(vec_b.data(), counts.data(), displs.data(), MPI_INT, local_b->data(), counts[rank], MPI_INT, 0, comm);
+
+        return [=]() {
+            long long local_dot_product = std::inner_product(local_a->begin(), local_a->end(), local_b->begin(), 0LL);
+            long long global_dot_product = 0;
+            MPI_Reduce(&local_dot_product, &global_dot_product, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+            return double(global_dot_product);
+        };
+    } });
+
+// ---- MPI_3: ping-pong between ranks 0 and 1 --------------------------------
+
+static Registrar mpi_pingpong(Kernel{ "mpi_pingpong", "MPI_3", { 1024, 2048, 4096, 8192, 16384 }, { 1 }, { 2 },
+    [](const Params& p) -> Body {
+        MPI_Comm comm = g_comm;
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+        int n = static_cast<int>(p.size);
+        auto send_buffer = std::make_shared<std::vector<char>>(n, 'x');
+        auto recv_buffer = std::make_shared<std::vector<char>>(n);
+        const int iterations = 100;   // round trips per sample
+
+        return [=]() {
+            for (int i = 0; i < iterations; ++i) {
+                if (rank == 0) {
+                    MPI_Send(send_buffer->data(), n, MPI_CHAR, 1, 0, comm);
+                    MPI_Recv(recv_buffer->data(), n, MPI_CHAR, 1, 0, comm, MPI_STATUS_IGNORE);
+                }
+                else if (rank == 1) {
+                    MPI_Recv(recv_buffer->data(), n, MPI_CHAR, 0, 0, comm, MPI_STATUS_IGNORE);
+                    MPI_Send(send_buffer->data(), n, MPI_CHAR, 0, 0, comm);
+                }
+            }
+            return double(n) * iterations * 2;   // bytes moved
+        };
+    } });
+
+// ---- MPI_4: row-slab matrix multiply ---------------------------------------
+
+static Registrar mpi_matmul(Kernel{ "mpi_matmul", "MPI_4", { 16, 32, 64, 128, 256, 512, 1024, 2048 }, { 1 }, mpi_ranks,
+    [](const Params& p) -> Body {
+        MPI_Comm comm = g_comm;
+        int rank, nprocs;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &nprocs);
+        int N = static_cast<int>(p.size);
+
+        std::vector<int> rows, row_displs;
+        block_partition(N, nprocs, rows, row_displs);
+        auto counts = std::make_shared<std::vector<int>>(nprocs);
+        auto displs = std::make_shared<std::vector<int>>(nprocs);
+        for (int i = 0; i < nprocs; ++i) {
+            (*counts)[i] = rows[i] * N;
+            (*displs)[i] = row_displs[i] * N;
+        }
+
+        auto A = std::make_shared<std::vector<double>>();
+        auto B = std::make_shared<std::vector<double>>(N * N);
+        auto fullC = std::make_shared<std::vector<double>>();
+        if (rank == 0) {
+            A->resize(N * N);
+            fullC->resize(N * N);
+            std::mt19937 gen(42);
+            for (double& x : *A) x = gen() % 10;
+            for (double& x : *B) x = gen() % 10;
+        }
+
+        return [=]() {
+            int my_rows = rows[rank];
+            std::vector<double> localA(my_rows * N), C(my_rows * N, 0.0);
+            MPI_Scatterv(A->data(), counts->data(), displs->data(), MPI_DOUBLE,
+                localA.data(), my_rows * N, MPI_DOUBLE, 0, comm);
+            MPI_Bcast(B->data(), N * N, MPI_DOUBLE, 0, comm);
+
+            for (int i = 0; i < my_rows; ++i) {
+                for (int j = 0; j < N; ++j) {
+                    for (int k = 0; k < N; ++k) {
+                        C[i * N + j] += localA[i * N + k] * (*B)[k * N + j];
+                    }
+                }
+            }
+
+            MPI_Gatherv(C.data(), my_rows * N, MPI_DOUBLE,
+                fullC->data(), counts->data(), displs->data(), MPI_DOUBLE, 0, comm);
+            return rank == 0 ? std::accumulate(fullC->begin(), fullC->end(), 0.0) : 0.0;
+        };
+    } });
+
+// ---- Command line ----------------------------------------------------------
+
+static void print_usage() {
+    std::cout << "Usage: benchmark_driver [options]\n"
+        << "  --list                 list the registered kernels and exit\n"
+        << "  --filter a,b           run kernels whose name contains any of the given substrings\n"
+        << "  --sizes n1,n2          only run these problem sizes\n"
+        << "  --threads t1,t2        only run these thread counts\n"
+        << "  --ranks r1,r2          only run these rank counts\n"
+        << "  --warmup N             untimed runs per configuration (default 2)\n"
+        << "  --reps N               timed samples per configuration (default 10)\n"
+        << "  --format table|csv|json\n";
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    bench::Options options;
+    bench::Filter filter;
+    bench::Format format = bench::Format::Table;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--list") list = true;
+        else if (arg == "--filter" && has_value) filter.names = bench::split(argv[++i]);
+        else if (arg == "--sizes" && has_value) {
+            for (const std::string& s : bench::split(argv[++i])) filter.sizes.push_back(std::stoll(s));
+        }
+        else if (arg == "--threads" && has_value) {
+            for (const std::string& s : bench::split(argv[++i])) filter.threads.push_back(std::stoi(s));
+        }
+        else if (arg == "--ranks" && has_value) {
+            for (const std::string& s : bench::split(argv[++i])) filter.ranks.push_back(std::stoi(s));
+        }
+        else if (arg == "--warmup" && has_value) options.warmup = std::stoi(argv[++i]);
+        else if (arg == "--reps" && has_value) options.repetitions = std::stoi(argv[++i]);
+        else if (arg == "--format" && has_value && bench::parse_format(argv[++i], format)) {}
+        else {
+            if (rank == 0) print_usage();
+            MPI_Finalize();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (list) {
+        if (rank == 0) {
+            for (const Kernel& k : bench::registry()) {
+                if (filter.match_name(k.name)) {
+                    std::cout << k.name << " (" << k.program << ")\n";
+                }
+            }
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    bench::Reporter reporter(std::cout, format);
+    if (rank == 0) reporter.begin();
+
+    for (const Kernel& kernel : bench::registry()) {
+        if (!filter.match_name(kernel.name)) continue;
+
+        for (const Params& p : bench::expand(kernel, filter)) {
+            if (p.ranks > size) continue;
+
+            MPI_Comm comm;
+            MPI_Comm_split(MPI_COMM_WORLD, rank < p.ranks ? 0 : MPI_UNDEFINED, rank, &comm);
+
+            if (comm != MPI_COMM_NULL) {
+                omp_set_num_threads(p.threads);
+                g_comm = comm;
+
+                bench::Timing timing;
+                timing.sync = [comm]() { MPI_Barrier(comm); };
+                timing.combine = [comm](double t) {
+                    double max_t;
+                    MPI_Allreduce(&t, &max_t, 1, MPI_DOUBLE, MPI_MAX, comm);
+                    return max_t;
+                };
+
+                bench::Result result = bench::run(kernel, p, options, timing);
+                if (rank == 0) reporter.add(result);
+
+                g_comm = MPI_COMM_WORLD;
+                MPI_Comm_free(&comm);
+            }
+
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+
+    if (rank == 0) reporter.end();
+
+    MPI_Finalize();
+    return 0;
+}
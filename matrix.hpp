@@ -0,0 +1,117 @@
+#pragma once
+
+// Dense row-major matrix in one contiguous, 64-byte aligned buffer.
+//
+// Rows are padded to a whole number of cache lines (stride >= cols), so every
+// row starts on a cache-line boundary and the SIMD kernels can use aligned
+// loads. A matrix is one allocation instead of one per row, and consecutive
+// rows are consecutive in memory, which keeps the hardware prefetcher busy.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+namespace matrix {
+
+const size_t ALIGNMENT = 64;
+
+// Non-owning view of one row
+template <typename T>
+class RowView {
+public:
+    RowView(T* data, int size) : data_(data), size_(size) {}
+
+    T* data() const { return data_; }
+    int size() const { return size_; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](int j) const { return data_[j]; }
+
+private:
+    T* data_;
+    int size_;
+};
+
+template <typename T>
+class Matrix {
+public:
+    Matrix() = default;
+
+    Matrix(int rows, int cols, T value = T())
+        : rows_(rows), cols_(cols), stride_(padded_stride(cols)) {
+        size_t bytes = std::max<size_t>(static_cast<size_t>(rows_) * stride_ * sizeof(T), ALIGNMENT);
+        data_ = static_cast<T*>(std::aligned_alloc(ALIGNMENT, (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT));
+        if (!data_) throw std::bad_alloc();
+        std::fill(data_, data_ + static_cast<size_t>(rows_) * stride_, value);
+    }
+
+    ~Matrix() { std::free(data_); }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    Matrix(Matrix&& other) noexcept { swap(other); }
+    Matrix& operator=(Matrix&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int stride() const { return stride_; }   // Elements between the starts of two rows
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    T* row_data(int i) { return data_ + static_cast<size_t>(i) * stride_; }
+    const T* row_data(int i) const { return data_ + static_cast<size_t>(i) * stride_; }
+
+    RowView<T> row(int i) { return RowView<T>(row_data(i), cols_); }
+    RowView<const T> row(int i) const { return RowView<const T>(row_data(i), cols_); }
+
+    T& operator()(int i, int j) { return row_data(i)[j]; }
+    const T& operator()(int i, int j) const { return row_data(i)[j]; }
+
+    // Bytes of the buffer, padding included
+    size_t bytes() const { return static_cast<size_t>(rows_) * stride_ * sizeof(T); }
+
+private:
+    static int padded_stride(int cols) {
+        const int per_line = static_cast<int>(ALIGNMENT / sizeof(T));
+        return (cols + per_line - 1) / per_line * per_line;
+    }
+
+    void swap(Matrix& other) {
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(stride_, other.stride_);
+        std::swap(data_, other.data_);
+    }
+
+    int rows_ = 0;
+    int cols_ = 0;
+    int stride_ = 0;
+    T* data_ = nullptr;
+};
+
+// Minimum of n elements starting on a cache-line boundary (a row of a Matrix).
+// Several SIMD lanes keep partial minimums; the padding is never read.
+template <typename T>
+T row_min(const T* row, int n) {
+    const T* data = static_cast<const T*>(__builtin_assume_aligned(row, ALIGNMENT));
+    T result = std::numeric_limits<T>::max();
+    #pragma omp simd reduction(min:result)
+    for (int j = 0; j < n; ++j) {
+        result = data[j] < result ? data[j] : result;
+    }
+    return result;
+}
+
+template <typename T>
+T row_min(const Matrix<T>& m, int i) {
+    return row_min(m.row_data(i), m.cols());
+}
+
+} // namespace matrix
@@ -0,0 +1,187 @@
+#pragma once
+
+// Fused min + max of an int array with SSE2 / AVX2 / AVX-512 code paths.
+//
+// Every path keeps several independent min and max accumulators so the
+// compare latency is hidden and one pass over memory gives both results.
+// The path is chosen once at runtime from CPUID (__builtin_cpu_supports),
+// so the binary can be built without -mavx2 and still use the wide units.
+
+#include <cstddef>
+#include <climits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINMAX_SIMD_X86 1
+#endif
+
+namespace minmax_simd {
+
+using Kernel = void (*)(const int* data, size_t n, int& min_value, int& max_value);
+
+inline void minmax_scalar(const int* data, size_t n, int& min_value, int& max_value) {
+    int mn = min_value, mx = max_value;
+    for (size_t i = 0; i < n; ++i) {
+        mn = data[i] < mn ? data[i] : mn;
+        mx = data[i] > mx ? data[i] : mx;
+    }
+    min_value = mn;
+    max_value = mx;
+}
+
+#ifdef MINMAX_SIMD_X86
+
+// GCC 12 reports the _mm*_undefined_* placeholders inside the intrinsics as uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// SSE2 has no packed 32-bit min/max, so they are built from compare + select
+__attribute__((target("sse2")))
+inline __m128i min_epi32_sse2(__m128i a, __m128i b) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+__attribute__((target("sse2")))
+inline __m128i max_epi32_sse2(__m128i a, __m128i b) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+__attribute__((target("sse2")))
+inline void minmax_sse2(const int* data, size_t n, int& min_value, int& max_value) {
+    __m128i mn0 = _mm_set1_epi32(min_value), mn1 = mn0;
+    __m128i mx0 = _mm_set1_epi32(max_value), mx1 = mx0;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4));
+        mn0 = min_epi32_sse2(mn0, a);
+        mn1 = min_epi32_sse2(mn1, b);
+        mx0 = max_epi32_sse2(mx0, a);
+        mx1 = max_epi32_sse2(mx1, b);
+    }
+
+    alignas(16) int lo[4], hi[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lo), min_epi32_sse2(mn0, mn1));
+    _mm_store_si128(reinterpret_cast<__m128i*>(hi), max_epi32_sse2(mx0, mx1));
+    for (int k = 0; k < 4; ++k) {
+        if (lo[k] < min_value) min_value = lo[k];
+        if (hi[k] > max_value) max_value = hi[k];
+    }
+    minmax_scalar(data + i, n - i, min_value, max_value);
+}
+
+__attribute__((target("avx2")))
+inline void minmax_avx2(const int* data, size_t n, int& min_value, int& max_value) {
+    __m256i mn0 = _mm256_set1_epi32(min_value), mn1 = mn0, mn2 = mn0, mn3 = mn0;
+    __m256i mx0 = _mm256_set1_epi32(max_value), mx1 = mx0, mx2 = mx0, mx3 = mx0;
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 8));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 16));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 24));
+        mn0 = _mm256_min_epi32(mn0, a);
+        mn1 = _mm256_min_epi32(mn1, b);
+        mn2 = _mm256_min_epi32(mn2, c);
+        mn3 = _mm256_min_epi32(mn3, d);
+        mx0 = _mm256_max_epi32(mx0, a);
+        mx1 = _mm256_max_epi32(mx1, b);
+        mx2 = _mm256_max_epi32(mx2, c);
+        mx3 = _mm256_max_epi32(mx3, d);
+    }
+
+    __m256i mn = _mm256_min_epi32(_mm256_min_epi32(mn0, mn1), _mm256_min_epi32(mn2, mn3));
+    __m256i mx = _mm256_max_epi32(_mm256_max_epi32(mx0, mx1), _mm256_max_epi32(mx2, mx3));
+
+    alignas(32) int lo[8], hi[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lo), mn);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(hi), mx);
+    for (int k = 0; k < 8; ++k) {
+        if (lo[k] < min_value) min_value = lo[k];
+        if (hi[k] > max_value) max_value = hi[k];
+    }
+    minmax_scalar(data + i, n - i, min_value, max_value);
+}
+
+__attribute__((target("avx512f")))
+inline void minmax_avx512(const int* data, size_t n, int& min_value, int& max_value) {
+    __m512i mn0 = _mm512_set1_epi32(min_value), mn1 = mn0, mn2 = mn0, mn3 = mn0;
+    __m512i mx0 = _mm512_set1_epi32(max_value), mx1 = mx0, mx2 = mx0, mx3 = mx0;
+
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i a = _mm512_loadu_si512(data + i);
+        __m512i b = _mm512_loadu_si512(data + i + 16);
+        __m512i c = _mm512_loadu_si512(data + i + 32);
+        __m512i d = _mm512_loadu_si512(data + i + 48);
+        mn0 = _mm512_min_epi32(mn0, a);
+        mn1 = _mm512_min_epi32(mn1, b);
+        mn2 = _mm512_min_epi32(mn2, c);
+        mn3 = _mm512_min_epi32(mn3, d);
+        mx0 = _mm512_max_epi32(mx0, a);
+        mx1 = _mm512_max_epi32(mx1, b);
+        mx2 = _mm512_max_epi32(mx2, c);
+        mx3 = _mm512_max_epi32(mx3, d);
+    }
+
+    __m512i mn = _mm512_min_epi32(_mm512_min_epi32(mn0, mn1), _mm512_min_epi32(mn2, mn3));
+    __m512i mx = _mm512_max_epi32(_mm512_max_epi32(mx0, mx1), _mm512_max_epi32(mx2, mx3));
+
+    for (; i + 16 <= n; i += 16) {
+        __m512i a = _mm512_loadu_si512(data + i);
+        mn = _mm512_min_epi32(mn, a);
+        mx = _mm512_max_epi32(mx, a);
+    }
+
+    // The last partial vector goes through a masked load instead of a scalar loop
+    if (i < n) {
+        __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512i a = _mm512_maskz_loadu_epi32(tail, data + i);
+        mn = _mm512_mask_min_epi32(mn, tail, mn, a);
+        mx = _mm512_mask_max_epi32(mx, tail, mx, a);
+    }
+
+    int lo = _mm512_reduce_min_epi32(mn);
+    int hi = _mm512_reduce_max_epi32(mx);
+    if (lo < min_value) min_value = lo;
+    if (hi > max_value) max_value = hi;
+}
+
+#pragma GCC diagnostic pop
+
+#endif // MINMAX_SIMD_X86
+
+struct Dispatch {
+    Kernel kernel;
+    const char* name;
+};
+
+// Picks the widest path the CPU supports; evaluated once
+inline const Dispatch& dispatch() {
+    static const Dispatch selected = []() -> Dispatch {
+#ifdef MINMAX_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return { minmax_avx512, "avx512" };
+        if (__builtin_cpu_supports("avx2")) return { minmax_avx2, "avx2" };
+        if (__builtin_cpu_supports("sse2")) return { minmax_sse2, "sse2" };
+#endif
+        return { minmax_scalar, "scalar" };
+    }();
+    return selected;
+}
+
+// Folds data[0..n) into min_value / max_value with the dispatched kernel
+inline void minmax(const int* data, size_t n, int& min_value, int& max_value) {
+    dispatch().kernel(data, n, min_value, max_value);
+}
+
+inline const char* isa_name() {
+    return dispatch().name;
+}
+
+} // namespace minmax_simd
@@ -0,0 +1,128 @@
+#pragma once
+
+// Fused min / max / argmin / argmax / sum reduction as a single MPI collective.
+//
+// MinMax<T> is the partial result of one rank. FusedMinMax<T> owns the MPI
+// datatype and the user-defined MPI_Op that combine two partials, so the
+// global min and max (plus their positions and the sum) come out of one
+// MPI_Reduce / MPI_Allreduce / MPI_Iallreduce instead of one call per quantity.
+//
+// FusedMinMax must be destroyed before MPI_Finalize.
+
+#include <mpi.h>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace mpi_minmax {
+
+template <typename T> MPI_Datatype mpi_type();
+template <> inline MPI_Datatype mpi_type<int>() { return MPI_INT; }
+template <> inline MPI_Datatype mpi_type<long long>() { return MPI_LONG_LONG; }
+template <> inline MPI_Datatype mpi_type<float>() { return MPI_FLOAT; }
+template <> inline MPI_Datatype mpi_type<double>() { return MPI_DOUBLE; }
+
+template <typename T>
+struct MinMax {
+    // Integer data is summed in 64 bits, floating point data in double
+    using sum_type = typename std::conditional<std::is_integral<T>::value, long long, double>::type;
+
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+    long long argmin = -1;   // global index, -1 while empty
+    long long argmax = -1;
+    sum_type sum = 0;
+
+    void add(T value, long long index) {
+        if (argmin < 0 || value < min || (value == min && index < argmin)) { min = value; argmin = index; }
+        if (argmax < 0 || value > max || (value == max && index < argmax)) { max = value; argmax = index; }
+        sum += value;
+    }
+
+    // Ties keep the smaller index, so the result does not depend on the reduction order
+    void merge(const MinMax& other) {
+        if (other.argmin >= 0 && (argmin < 0 || other.min < min || (other.min == min && other.argmin < argmin))) {
+            min = other.min;
+            argmin = other.argmin;
+        }
+        if (other.argmax >= 0 && (argmax < 0 || other.max > max || (other.max == max && other.argmax < argmax))) {
+            max = other.max;
+            argmax = other.argmax;
+        }
+        sum += other.sum;
+    }
+};
+
+// Partial result of data[0..n), whose first element has global index offset
+template <typename T>
+MinMax<T> local_minmax(const T* data, size_t n, long long offset = 0) {
+    MinMax<T> r;
+    for (size_t i = 0; i < n; ++i) {
+        r.add(data[i], offset + static_cast<long long>(i));
+    }
+    return r;
+}
+
+template <typename T>
+class FusedMinMax {
+public:
+    FusedMinMax() {
+        using M = MinMax<T>;
+        int lengths[5] = { 1, 1, 1, 1, 1 };
+        MPI_Aint offsets[5] = { offsetof(M, min), offsetof(M, max), offsetof(M, argmin),
+                                offsetof(M, argmax), offsetof(M, sum) };
+        MPI_Datatype types[5] = { mpi_type<T>(), mpi_type<T>(), MPI_LONG_LONG, MPI_LONG_LONG,
+                                  mpi_type<typename M::sum_type>() };
+
+        MPI_Datatype tmp;
+        MPI_Type_create_struct(5, lengths, offsets, types, &tmp);
+        MPI_Type_create_resized(tmp, 0, sizeof(M), &type_);
+        MPI_Type_commit(&type_);
+        MPI_Type_free(&tmp);
+
+        MPI_Op_create(&FusedMinMax::combine, 1, &op_);
+    }
+
+    ~FusedMinMax() {
+        MPI_Op_free(&op_);
+        MPI_Type_free(&type_);
+    }
+
+    FusedMinMax(const FusedMinMax&) = delete;
+    FusedMinMax& operator=(const FusedMinMax&) = delete;
+
+    // Result is valid on root only
+    MinMax<T> reduce(const MinMax<T>& local, int root, MPI_Comm comm) const {
+        MinMax<T> global;
+        MPI_Reduce(&local, &global, 1, type_, op_, root, comm);
+        return global;
+    }
+
+    MinMax<T> allreduce(const MinMax<T>& local, MPI_Comm comm) const {
+        MinMax<T> global;
+        MPI_Allreduce(&local, &global, 1, type_, op_, comm);
+        return global;
+    }
+
+    // `local` and `global` must stay alive until the request completes
+    void iallreduce(const MinMax<T>& local, MinMax<T>& global, MPI_Comm comm, MPI_Request* request) const {
+        MPI_Iallreduce(&local, &global, 1, type_, op_, comm, request);
+    }
+
+    MPI_Datatype type() const { return type_; }
+    MPI_Op op() const { return op_; }
+
+private:
+    static void combine(void* in, void* inout, int* len, MPI_Datatype*) {
+        const MinMax<T>* a = static_cast<const MinMax<T>*>(in);
+        MinMax<T>* b = static_cast<MinMax<T>*>(inout);
+        for (int i = 0; i < *len; ++i) {
+            b[i].merge(a[i]);
+        }
+    }
+
+    MPI_Datatype type_;
+    MPI_Op op_;
+};
+
+} // namespace mpi_minmax
@@ -0,0 +1,88 @@
+#pragma once
+
+// Philox4x32-10 counter-based random number generator (Salmon et al., SC'11).
+//
+// The output is a pure function of (key, counter), so element i of a random
+// vector can be computed by any rank without generating elements 0..i-1.
+// A distributed vector generated shard by shard is therefore bit-identical to
+// the same vector generated serially, whatever the number of ranks.
+
+#include <cstdint>
+#include <cstddef>
+
+namespace philox {
+
+struct Block {
+    uint32_t v[4];
+};
+
+inline void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+    uint64_t product = static_cast<uint64_t>(a) * b;
+    hi = static_cast<uint32_t>(product >> 32);
+    lo = static_cast<uint32_t>(product);
+}
+
+// One 128-bit block of output for a 128-bit counter and a 64-bit key
+inline Block philox4x32(Block ctr, uint64_t key) {
+    const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+
+    for (int round = 0; round < 10; ++round) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulhilo(M0, ctr.v[0], hi0, lo0);
+        mulhilo(M1, ctr.v[2], hi1, lo1);
+        ctr = Block{ { hi1 ^ ctr.v[1] ^ k0, lo1, hi0 ^ ctr.v[3] ^ k1, lo0 } };
+        k0 += W0;
+        k1 += W1;
+    }
+    return ctr;
+}
+
+// Block number `index` of stream `stream`
+inline Block block_at(uint64_t seed, uint64_t stream, uint64_t index) {
+    Block ctr{ { static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+                 static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32) } };
+    return philox4x32(ctr, seed);
+}
+
+// The index-th 32-bit value of a stream
+inline uint32_t at(uint64_t seed, uint64_t stream, uint64_t index) {
+    return block_at(seed, stream, index / 4).v[index % 4];
+}
+
+// Maps a 32-bit value onto [lo, hi] with a multiply-shift (no division)
+inline int to_range(uint32_t x, int lo, int hi) {
+    uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo + 1);
+    return lo + static_cast<int>((static_cast<uint64_t>(x) * span) >> 32);
+}
+
+// Fills out[0..count) with elements [offset, offset + count) of the global
+// vector of uniform ints in [lo, hi] described by (seed, stream)
+inline void fill_uniform_int(int* out, uint64_t offset, size_t count,
+                             uint64_t seed, uint64_t stream, int lo, int hi) {
+    size_t i = 0;
+
+    // Head: finish the block that offset starts in
+    while (i < count && (offset + i) % 4 != 0) {
+        out[i] = to_range(at(seed, stream, offset + i), lo, hi);
+        ++i;
+    }
+
+    // Body: one Philox call per four outputs
+    for (; i + 4 <= count; i += 4) {
+        Block b = block_at(seed, stream, (offset + i) / 4);
+        out[i] = to_range(b.v[0], lo, hi);
+        out[i + 1] = to_range(b.v[1], lo, hi);
+        out[i + 2] = to_range(b.v[2], lo, hi);
+        out[i + 3] = to_range(b.v[3], lo, hi);
+    }
+
+    for (; i < count; ++i) {
+        out[i] = to_range(at(seed, stream, offset + i), lo, hi);
+    }
+}
+
+} // namespace philox
@@ -0,0 +1,156 @@
+#pragma once
+
+// Sample streams for distributed Monte Carlo and quasi-Monte Carlo integration.
+//
+// Both streams can jump straight to any sample index, so a rank or thread
+// starts its block of samples without generating the ones before it:
+//   Philox  sample i of replicate r uses counters i * blocks .. i * blocks + blocks - 1
+//           of Philox stream r (counter-based skip-ahead)
+//   Sobol   point i is the XOR of the direction numbers selected by the Gray code of i,
+//           after which the Gray-code recurrence steps to i + 1 with a single XOR
+// Sobol points are scrambled with a random digital shift (an XOR per dimension),
+// and independent shifts give independent replicates for the error estimate.
+
+#include <cstdint>
+#include <vector>
+
+#include "philox.hpp"
+
+namespace qmc {
+
+// Compensated (Kahan) summation
+struct Kahan {
+    double sum = 0.0;
+    double compensation = 0.0;   // Low-order part lost by the last additions, negated
+
+    void add(double x) {
+        double y = x - compensation;
+        double t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+
+    double value() const { return sum - compensation; }
+};
+
+// Maps 32 random bits to the open interval (0, 1)
+inline double to_unit(uint32_t x) {
+    return (static_cast<double>(x) + 0.5) * (1.0 / 4294967296.0);
+}
+
+// Sample i of replicate r: d uniforms from Philox stream r
+class PhiloxStream {
+public:
+    PhiloxStream(int dims, uint64_t seed) : dims_(dims), blocks_((dims + 3) / 4), seed_(seed) {}
+
+    void sample(uint64_t replicate, uint64_t index, double* u) const {
+        for (int b = 0; b < blocks_; ++b) {
+            philox::Block block = philox::block_at(seed_, replicate, index * blocks_ + b);
+            for (int j = 0; j < 4 && 4 * b + j < dims_; ++j) {
+                u[4 * b + j] = to_unit(block.v[j]);
+            }
+        }
+    }
+
+private:
+    int dims_;
+    int blocks_;
+    uint64_t seed_;
+};
+
+const int SOBOL_MAX_DIMS = 20;
+const int SOBOL_BITS = 32;
+
+// Primitive polynomials and initial direction numbers of dimensions 2..20 (Joe and Kuo, new-joe-kuo-6.21201)
+struct SobolInit {
+    int degree;
+    uint32_t coefficients;
+    uint32_t m[7];
+};
+
+const SobolInit SOBOL_INIT[SOBOL_MAX_DIMS - 1] = {
+    { 1, 0, { 1 } },
+    { 2, 1, { 1, 3 } },
+    { 3, 1, { 1, 3, 1 } },
+    { 3, 2, { 1, 1, 1 } },
+    { 4, 1, { 1, 1, 3, 3 } },
+    { 4, 4, { 1, 3, 5, 13 } },
+    { 5, 2, { 1, 1, 5, 5, 17 } },
+    { 5, 4, { 1, 1, 5, 5, 5 } },
+    { 5, 7, { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+};
+
+// Sobol sequence in up to SOBOL_MAX_DIMS dimensions and 2^32 points
+class Sobol {
+public:
+    explicit Sobol(int dims) : dims_(dims), v_(static_cast<size_t>(dims) * SOBOL_BITS) {
+        for (int k = 0; k < SOBOL_BITS; ++k) {
+            v_[k] = 1u << (31 - k);
+        }
+        for (int j = 1; j < dims; ++j) {
+            const SobolInit& init = SOBOL_INIT[j - 1];
+            const int s = init.degree;
+            uint32_t* v = v_.data() + static_cast<size_t>(j) * SOBOL_BITS;
+            for (int k = 0; k < SOBOL_BITS; ++k) {
+                if (k < s) {
+                    v[k] = init.m[k] << (31 - k);
+                    continue;
+                }
+                v[k] = v[k - s] ^ (v[k - s] >> s);
+                for (int i = 1; i < s; ++i) {
+                    if ((init.coefficients >> (s - 1 - i)) & 1) {
+                        v[k] ^= v[k - i];
+                    }
+                }
+            }
+        }
+    }
+
+    int dims() const { return dims_; }
+
+    // Integer coordinates of point `index`, computed directly (skip-ahead)
+    void point(uint32_t index, uint32_t* x) const {
+        uint32_t gray = index ^ (index >> 1);
+        for (int j = 0; j < dims_; ++j) {
+            const uint32_t* v = v_.data() + static_cast<size_t>(j) * SOBOL_BITS;
+            uint32_t value = 0;
+            for (int k = 0; gray >> k; ++k) {
+                if ((gray >> k) & 1) value ^= v[k];
+            }
+            x[j] = value;
+        }
+    }
+
+    // Turns point `index` in x into point index + 1
+    void next(uint32_t index, uint32_t* x) const {
+        int k = __builtin_ctz(index + 1);
+        for (int j = 0; j < dims_; ++j) {
+            x[j] ^= v_[static_cast<size_t>(j) * SOBOL_BITS + k];
+        }
+    }
+
+private:
+    int dims_;
+    std::vector<uint32_t> v_;   // Direction numbers, SOBOL_BITS per dimension
+};
+
+// Random digital shift of every dimension of `replicates` independent scramblings
+inline std::vector<uint32_t> digital_shifts(int dims, int replicates, uint64_t seed) {
+    std::vector<uint32_t> shifts(static_cast<size_t>(dims) * replicates);
+    for (size_t i = 0; i < shifts.size(); ++i) {
+        shifts[i] = philox::at(seed, 0x5ca1ab1e, i);
+    }
+    return shifts;
+}
+
+} // namespace qmc
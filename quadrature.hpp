@@ -0,0 +1,164 @@
+#pragma once
+
+// Numerical integration of any callable.
+//
+// The integrand is a template parameter, so a lambda or function object is
+// inlined into the rule instead of being called through a pointer. Each rule
+// returns an estimate together with an error estimate:
+//   Simpson          S on [a, b] against S on both halves (Richardson)
+//   GaussLegendre    5-point rule on [a, b] against the rule on both halves
+//   GaussKronrod     7-point Gauss rule embedded in the 15-point Kronrod rule
+// integrate() bisects every interval whose error estimate is above its share
+// of the tolerance. The two halves of an interval become OpenMP tasks down to
+// task_depth; below it the recursion runs inside the task, so the number of
+// tasks stays bounded while the busiest subtrees still spread over threads.
+
+#include <cmath>
+
+namespace quadrature {
+
+struct Estimate {
+    double value = 0.0;
+    double error = 0.0;          // Estimated absolute error
+    long long evaluations = 0;   // Calls of the integrand
+};
+
+struct Simpson {
+    static double rule(double a, double fa, double fm, double b, double fb) {
+        return (b - a) / 6.0 * (fa + 4.0 * fm + fb);
+    }
+
+    template <typename F>
+    Estimate operator()(F& f, double a, double b) const {
+        double m = 0.5 * (a + b);
+        double fa = f(a), fm = f(m), fb = f(b);
+        double lm = 0.5 * (a + m), rm = 0.5 * (m + b);
+        double flm = f(lm), frm = f(rm);
+
+        double whole = rule(a, fa, fm, b, fb);
+        double halves = rule(a, fa, flm, m, fm) + rule(m, fm, frm, b, fb);
+
+        Estimate e;
+        e.value = halves + (halves - whole) / 15.0;
+        e.error = std::fabs(halves - whole) / 15.0;
+        e.evaluations = 5;
+        return e;
+    }
+};
+
+struct GaussLegendre {
+    template <typename F>
+    static double rule(F& f, double a, double b) {
+        static const double nodes[5] = { 0.0, 0.5384693101056831, -0.5384693101056831, 0.9061798459386640, -0.9061798459386640 };
+        static const double weights[5] = { 0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891 };
+        double c = 0.5 * (a + b), h = 0.5 * (b - a);
+        double sum = 0.0;
+        for (int i = 0; i < 5; ++i) {
+            sum += weights[i] * f(c + h * nodes[i]);
+        }
+        return h * sum;
+    }
+
+    template <typename F>
+    Estimate operator()(F& f, double a, double b) const {
+        double m = 0.5 * (a + b);
+        double whole = rule(f, a, b);
+        double halves = rule(f, a, m) + rule(f, m, b);
+
+        Estimate e;
+        e.value = halves;
+        e.error = std::fabs(halves - whole);
+        e.evaluations = 15;
+        return e;
+    }
+};
+
+struct GaussKronrod {
+    template <typename F>
+    Estimate operator()(F& f, double a, double b) const {
+        // Kronrod nodes on [0, 1): the odd entries are the 7-point Gauss nodes
+        static const double nodes[8] = {
+            0.991455371120812639, 0.949107912342758525, 0.864864423359769073, 0.741531185599394440,
+            0.586087235467691130, 0.405845151377397167, 0.207784955007898468, 0.0 };
+        static const double kronrod[8] = {
+            0.022935322010529225, 0.063092092629978553, 0.104790010322250184, 0.140653259715525919,
+            0.169004726639267903, 0.190350578064785410, 0.204432940075298892, 0.209482141084727828 };
+        static const double gauss[4] = {
+            0.129484966168869693, 0.279705391489276668, 0.381830050505118945, 0.417959183673469388 };
+
+        double c = 0.5 * (a + b), h = 0.5 * (b - a);
+        double fc = f(c);
+        double k = kronrod[7] * fc, g = gauss[3] * fc;
+        for (int i = 0; i < 7; ++i) {
+            double pair = f(c - h * nodes[i]) + f(c + h * nodes[i]);
+            k += kronrod[i] * pair;
+            if (i % 2 == 1) {
+                g += gauss[i / 2] * pair;
+            }
+        }
+
+        Estimate e;
+        e.value = h * k;
+        e.error = std::fabs(h * (k - g));
+        e.evaluations = 15;
+        return e;
+    }
+};
+
+struct Options {
+    int max_depth = 50;    // Intervals are not split below (b - a) / 2^max_depth
+    int task_depth = 10;   // Subdivisions above this depth run as OpenMP tasks
+};
+
+template <typename F, typename Rule>
+Estimate adapt(F& f, double a, double b, double tolerance, const Rule& rule, const Options& options, int depth) {
+    Estimate whole = rule(f, a, b);
+    if (whole.error <= tolerance || depth >= options.max_depth) {
+        return whole;
+    }
+
+    double m = 0.5 * (a + b);
+    Estimate left, right;
+    if (depth < options.task_depth) {
+        #pragma omp task shared(left, f, rule, options)
+        left = adapt(f, a, m, 0.5 * tolerance, rule, options, depth + 1);
+        right = adapt(f, m, b, 0.5 * tolerance, rule, options, depth + 1);
+        #pragma omp taskwait
+    }
+    else {
+        left = adapt(f, a, m, 0.5 * tolerance, rule, options, depth + 1);
+        right = adapt(f, m, b, 0.5 * tolerance, rule, options, depth + 1);
+    }
+
+    Estimate e;
+    e.value = left.value + right.value;
+    e.error = left.error + right.error;
+    e.evaluations = whole.evaluations + left.evaluations + right.evaluations;
+    return e;
+}
+
+// Integral of f over [a, b] to an estimated absolute error of `tolerance`
+template <typename F, typename Rule>
+Estimate integrate(F f, double a, double b, double tolerance, const Rule& rule, int threads, const Options& options = Options()) {
+    Estimate result;
+    #pragma omp parallel num_threads(threads)
+    #pragma omp single
+    result = adapt(f, a, b, tolerance, rule, options, 0);
+    return result;
+}
+
+// Fixed-step left rectangle rule with an OpenMP reduction, the baseline
+template <typename F>
+double rectangle(F f, double a, double b, long long N, int threads) {
+    double sum = 0.0;
+    double dx = (b - a) / N;
+
+    #pragma omp parallel for reduction(+:sum) num_threads(threads)
+    for (long long i = 0; i < N; ++i) {
+        sum += f(a + i * dx);
+    }
+
+    return sum * dx;
+}
+
+} // namespace quadrature
@@ -0,0 +1,186 @@
+#pragma once
+
+// Per-thread random number generators without shared state.
+//
+// rand() keeps one global state behind a lock, so threads that draw numbers
+// in a loop serialize on it. Here every thread owns its generator, and each
+// generator sits in its own cache line so neighbouring threads do not
+// false-share the state either.
+//   Xoshiro256ss  xoshiro256** (Blackman and Vigna): 256-bit state, 64-bit
+//                 output; jump() advances 2^128 steps, giving every thread a
+//                 non-overlapping subsequence of one seed
+//   Philox        Philox4x32-10 from philox.hpp as an engine: thread t uses
+//                 stream t, and discard(n) jumps any distance in O(1)
+// Both model UniformRandomBitGenerator, so they also work with <random>.
+// fill_uniform_int generates data in parallel from Philox counters, so the
+// values do not depend on the number of threads.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "philox.hpp"
+
+namespace rng {
+
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+class Xoshiro256ss {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256ss(uint64_t seed = 0) {
+        for (uint64_t& word : s_) word = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Equivalent to 2^128 calls of operator()
+    void jump() {
+        static const uint64_t JUMP[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+        uint64_t s[4] = { 0, 0, 0, 0 };
+        for (uint64_t word : JUMP) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (uint64_t(1) << b)) {
+                    for (int i = 0; i < 4; ++i) s[i] ^= s_[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; ++i) s_[i] = s[i];
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+class Philox {
+public:
+    using result_type = uint32_t;
+
+    explicit Philox(uint64_t seed = 0, uint64_t stream = 0) : seed_(seed), stream_(stream) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (position_ % 4 == 0) {
+            block_ = philox::block_at(seed_, stream_, position_ / 4);
+        }
+        return block_.v[position_++ % 4];
+    }
+
+    // Skips n outputs
+    void discard(uint64_t n) {
+        position_ += n;
+        if (position_ % 4 != 0) {
+            block_ = philox::block_at(seed_, stream_, position_ / 4);
+        }
+    }
+
+private:
+    uint64_t seed_;
+    uint64_t stream_;
+    uint64_t position_ = 0;
+    philox::Block block_{};
+};
+
+// Integer in [lo, hi] from one output with a multiply-shift (no division, no lock)
+template <typename Engine>
+int uniform_int(Engine& engine, int lo, int hi) {
+    return philox::to_range(static_cast<uint32_t>(engine() >> (8 * sizeof(typename Engine::result_type) - 32)), lo, hi);
+}
+
+// One engine per thread, each on its own cache line
+template <typename Engine>
+class PerThread {
+public:
+    PerThread(uint64_t seed, int threads);
+
+    // The engine of the calling OpenMP thread
+    Engine& local() {
+#ifdef _OPENMP
+        return engines_[omp_get_thread_num()].engine;
+#else
+        return engines_[0].engine;
+#endif
+    }
+
+    Engine& operator[](int thread) { return engines_[thread].engine; }
+    int size() const { return static_cast<int>(engines_.size()); }
+
+private:
+    struct alignas(64) Padded {
+        Engine engine;
+    };
+
+    std::vector<Padded> engines_;
+};
+
+// Thread t starts t jumps of 2^128 into the sequence of the seed
+template <>
+inline PerThread<Xoshiro256ss>::PerThread(uint64_t seed, int threads) {
+    Xoshiro256ss engine(seed);
+    for (int t = 0; t < threads; ++t) {
+        engines_.push_back(Padded{ engine });
+        engine.jump();
+    }
+}
+
+// Thread t uses Philox stream t
+template <>
+inline PerThread<Philox>::PerThread(uint64_t seed, int threads) {
+    for (int t = 0; t < threads; ++t) {
+        engines_.push_back(Padded{ Philox(seed, static_cast<uint64_t>(t)) });
+    }
+}
+
+// out[i] = element i of the uniform [lo, hi] vector of (seed, stream), generated by `threads` threads.
+// Same values for any thread count: every element comes from its own Philox counter.
+inline void fill_uniform_int(int* out, size_t n, int lo, int hi, uint64_t seed, uint64_t stream = 0, int threads = 0) {
+    const long long CHUNK = 4096;   // Multiple of 4, so chunks start on a Philox block
+    const long long chunks = static_cast<long long>((n + CHUNK - 1) / CHUNK);
+#ifdef _OPENMP
+    if (threads <= 0) threads = omp_get_max_threads();
+#endif
+    #pragma omp parallel for schedule(static) num_threads(threads > 0 ? threads : 1)
+    for (long long c = 0; c < chunks; ++c) {
+        size_t first = static_cast<size_t>(c) * CHUNK;
+        size_t count = std::min<size_t>(CHUNK, n - first);
+        philox::fill_uniform_int(out + first, first, count, seed, stream, lo, hi);
+    }
+}
+
+inline std::vector<int> uniform_ints(size_t n, int lo, int hi, uint64_t seed, uint64_t stream = 0, int threads = 0) {
+    std::vector<int> data(n);
+    fill_uniform_int(data.data(), n, lo, hi, seed, stream, threads);
+    return data;
+}
+
+} // namespace rng
@@ -0,0 +1,220 @@
+#pragma once
+
+// Distributed sample sort (parallel sorting by regular sampling, PSRS).
+//
+// 1. Every rank sorts its keys with OpenMP: each thread sorts one chunk with
+//    std::sort, then the chunks are merged pairwise.
+// 2. Every rank takes OVERSAMPLING * p regular samples of its sorted keys
+//    (p = ranks). The samples are all-gathered and sorted, and p - 1
+//    equally spaced ones become the splitters. Regular sampling bounds
+//    every bucket by about 2n / p keys, and oversampling brings them
+//    close to n / p.
+// 3. Each rank cuts its sorted keys at the splitters (binary search). The
+//    bucket sizes go out with MPI_Alltoall and the keys with MPI_Alltoallv.
+// 4. Each rank merges the p sorted runs it received.
+// Rank r then holds keys that are >= those of ranks < r and <= those of
+// ranks > r. Keys equal to a splitter all go to the same rank, so many
+// duplicates of one key unbalance the buckets but never break the order.
+//
+// Merges are parallel: the output is cut into one part per thread, and the
+// matching input positions are found by binary search (merge path / co-rank).
+
+#include <mpi.h>
+#include <omp.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "mpi_minmax.hpp"
+
+namespace sample_sort {
+
+const int OVERSAMPLING = 8;   // Samples per rank and bucket
+
+// Seconds spent in every phase on this rank
+struct Timings {
+    double local_sort = 0.0;
+    double sampling = 0.0;
+    double exchange = 0.0;
+    double merge = 0.0;
+};
+
+// Number of elements of a among the first k outputs of the stable merge of a and b
+template <typename T>
+size_t co_rank(size_t k, const T* a, size_t na, const T* b, size_t nb) {
+    size_t lo = k > nb ? k - nb : 0, hi = std::min(k, na);
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        if (b[k - i - 1] < a[i]) hi = i;
+        else lo = i + 1;
+    }
+    return lo;
+}
+
+// Stable merge of a and b into out, each thread writes one part of out
+template <typename T>
+void parallel_merge(const T* a, size_t na, const T* b, size_t nb, T* out, int threads) {
+    const size_t n = na + nb;
+    #pragma omp parallel num_threads(threads) if(n > 65536)
+    {
+        const int t = omp_get_thread_num(), team = omp_get_num_threads();
+        size_t first = n * t / team, last = n * (t + 1) / team;
+        size_t i0 = co_rank(first, a, na, b, nb), i1 = co_rank(last, a, na, b, nb);
+        std::merge(a + i0, a + i1, b + (first - i0), b + (last - i1), out + first);
+    }
+}
+
+// Merges the sorted runs [bounds[r], bounds[r + 1]) of data into one sorted run,
+// in log2(runs) rounds of pairwise merges; buffer is scratch of the same size
+template <typename T>
+void merge_runs(std::vector<T>& data, std::vector<T>& buffer, std::vector<size_t> bounds, int threads) {
+    buffer.resize(data.size());
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged(1, 0);
+        size_t runs = bounds.size() - 1;
+        for (size_t r = 0; r < runs; r += 2) {
+            size_t first = bounds[r], middle = bounds[r + 1];
+            size_t last = r + 1 < runs ? bounds[r + 2] : middle;
+            parallel_merge(data.data() + first, middle - first, data.data() + middle, last - middle,
+                buffer.data() + first, threads);
+            merged.push_back(last);
+        }
+        data.swap(buffer);
+        bounds.swap(merged);
+    }
+}
+
+// Sorts data with `threads` threads: one std::sort per chunk, then merge_runs
+template <typename T>
+void parallel_sort(std::vector<T>& data, std::vector<T>& buffer, int threads) {
+    const size_t n = data.size();
+    const int chunks = n < 65536 ? 1 : threads;
+    std::vector<size_t> bounds(chunks + 1);
+    for (int c = 0; c <= chunks; ++c) {
+        bounds[c] = n * c / chunks;
+    }
+
+    #pragma omp parallel for schedule(static, 1) num_threads(threads)
+    for (int c = 0; c < chunks; ++c) {
+        std::sort(data.begin() + bounds[c], data.begin() + bounds[c + 1]);
+    }
+
+    merge_runs(data, buffer, bounds, threads);
+}
+
+// Sorts the keys distributed over comm; returns this rank's part of the sorted sequence.
+// global is the fused min / max of all keys (from mpi_minmax): if they are all equal
+// every rank already holds a sorted part and nothing is exchanged.
+template <typename T>
+std::vector<T> sort(std::vector<T> keys, const mpi_minmax::MinMax<T>& global, MPI_Comm comm, int threads,
+                    Timings* timings = nullptr) {
+    int p;
+    MPI_Comm_size(comm, &p);
+    const MPI_Datatype type = mpi_minmax::mpi_type<T>();
+    Timings local;
+    std::vector<T> buffer;
+
+    double start = MPI_Wtime();
+    parallel_sort(keys, buffer, threads);
+    local.local_sort = MPI_Wtime() - start;
+
+    if (p == 1 || global.argmin < 0 || global.min == global.max) {
+        if (timings) *timings = local;
+        return keys;
+    }
+
+    // Regular samples: the first key of each of s equal parts of the local keys
+    start = MPI_Wtime();
+    const size_t n = keys.size();
+    const size_t s = static_cast<size_t>(OVERSAMPLING) * p;
+    std::vector<T> samples;
+    for (size_t i = 0; i < s && n > 0; ++i) {
+        samples.push_back(keys[i * n / s]);
+    }
+    int sample_count = static_cast<int>(samples.size());
+    std::vector<int> sample_counts(p), sample_displs(p, 0);
+    MPI_Allgather(&sample_count, 1, MPI_INT, sample_counts.data(), 1, MPI_INT, comm);
+    for (int r = 1; r < p; ++r) {
+        sample_displs[r] = sample_displs[r - 1] + sample_counts[r - 1];
+    }
+    std::vector<T> all_samples(sample_displs[p - 1] + sample_counts[p - 1]);
+    MPI_Allgatherv(samples.data(), sample_count, type, all_samples.data(), sample_counts.data(),
+        sample_displs.data(), type, comm);
+    std::sort(all_samples.begin(), all_samples.end());
+
+    // Bucket r holds the keys in (splitter r - 1, splitter r]
+    std::vector<int> send_counts(p), send_displs(p, 0);
+    size_t begin = 0;
+    for (int r = 0; r < p; ++r) {
+        size_t end = n;
+        if (r < p - 1) {
+            const T splitter = all_samples[(r + 1) * all_samples.size() / p];
+            end = std::upper_bound(keys.begin() + begin, keys.end(), splitter) - keys.begin();
+        }
+        send_displs[r] = static_cast<int>(begin);
+        send_counts[r] = static_cast<int>(end - begin);
+        begin = end;
+    }
+    local.sampling = MPI_Wtime() - start;
+
+    // Bucket exchange
+    start = MPI_Wtime();
+    std::vector<int> recv_counts(p), recv_displs(p, 0);
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+    for (int r = 1; r < p; ++r) {
+        recv_displs[r] = recv_displs[r - 1] + recv_counts[r - 1];
+    }
+    std::vector<T> received(static_cast<size_t>(recv_displs[p - 1]) + recv_counts[p - 1]);
+    MPI_Alltoallv(keys.data(), send_counts.data(), send_displs.data(), type,
+        received.data(), recv_counts.data(), recv_displs.data(), type, comm);
+    local.exchange = MPI_Wtime() - start;
+
+    // The p received runs are each sorted
+    start = MPI_Wtime();
+    std::vector<T>().swap(keys);
+    std::vector<size_t> bounds(p + 1);
+    for (int r = 0; r < p; ++r) {
+        bounds[r] = recv_displs[r];
+    }
+    bounds[p] = received.size();
+    merge_runs(received, buffer, bounds, threads);
+    local.merge = MPI_Wtime() - start;
+
+    if (timings) *timings = local;
+    return received;
+}
+
+// True on every rank if each part is sorted and no part starts below the end
+// of a nonempty part on a lower rank
+template <typename T>
+bool is_globally_sorted(const std::vector<T>& keys, MPI_Comm comm) {
+    int p;
+    MPI_Comm_size(comm, &p);
+    const MPI_Datatype type = mpi_minmax::mpi_type<T>();
+
+    int sorted = std::is_sorted(keys.begin(), keys.end()) ? 1 : 0;
+    int all_sorted;
+    MPI_Allreduce(&sorted, &all_sorted, 1, MPI_INT, MPI_LAND, comm);
+
+    int nonempty = keys.empty() ? 0 : 1;
+    T ends[2] = { T(), T() };
+    if (nonempty) {
+        ends[0] = keys.front();
+        ends[1] = keys.back();
+    }
+    std::vector<int> nonempties(p);
+    std::vector<T> all_ends(2 * static_cast<size_t>(p));
+    MPI_Allgather(&nonempty, 1, MPI_INT, nonempties.data(), 1, MPI_INT, comm);
+    MPI_Allgather(ends, 2, type, all_ends.data(), 2, type, comm);
+
+    bool ordered = true;
+    int previous = -1;
+    for (int r = 0; r < p; ++r) {
+        if (!nonempties[r]) continue;
+        if (previous >= 0 && all_ends[2 * r] < all_ends[2 * previous + 1]) ordered = false;
+        previous = r;
+    }
+    return all_sorted && ordered;
+}
+
+} // namespace sample_sort
@@ -0,0 +1,221 @@
+#pragma once
+
+// Parallel prefix sums (scans) with OpenMP.
+//
+// out[i] = init op in[0] op ... op in[i]       (INCLUSIVE, as std::inclusive_scan)
+// out[i] = init op in[0] op ... op in[i - 1]   (EXCLUSIVE, as std::exclusive_scan)
+// op must be associative; it need not be commutative and needs no identity.
+// out may alias in.
+//
+//   blocked   Two passes. Each thread scans its contiguous block. The block
+//             totals are scanned serially. Then every block except the first
+//             adds the total of the blocks before it (fixup). The fixup
+//             re-reads the output, so this moves about twice the minimum.
+//   lookback  Single pass with decoupled lookback (Merrill and Garland).
+//             Threads take tiles in order from a counter. A tile reduces
+//             itself and publishes its aggregate. It then walks back over
+//             its predecessors until it finds a published inclusive prefix,
+//             and publishes its own. Last, it scans the tile, which is still
+//             in cache. Memory is read once and written once.
+//   simd      blocked with the block stage as an omp simd inscan loop. The
+//             compiler turns it into log-step shifts and adds in registers.
+//             Only for +.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <omp.h>
+
+namespace scan {
+
+enum Mode { INCLUSIVE, EXCLUSIVE };
+
+const size_t TILE = 16384;   // Elements per lookback tile, small enough to stay in L2 between its two reads
+
+// Scans in[first, last) into out and returns the total of the range.
+// With has_seed the scan starts from `seed`. Without one it starts from
+// in[first]; for EXCLUSIVE, out[first] is then left for the caller.
+template <typename In, typename Out, typename Op>
+Out scan_range(const In* in, Out* out, size_t first, size_t last, Mode mode, Op op, bool has_seed, Out seed) {
+    size_t i = first;
+    Out carry = seed;
+    if (!has_seed) {
+        carry = static_cast<Out>(in[i]);
+        if (mode == INCLUSIVE) {
+            out[i] = carry;
+        }
+        ++i;
+    }
+    for (; i < last; ++i) {
+        Out value = static_cast<Out>(in[i]);
+        if (mode == INCLUSIVE) {
+            carry = op(carry, value);
+            out[i] = carry;
+        }
+        else {
+            out[i] = carry;
+            carry = op(carry, value);
+        }
+    }
+    return carry;
+}
+
+// The same for +, vectorized as an OpenMP 5 inscan reduction
+template <typename In, typename Out>
+Out scan_range_simd(const In* in, Out* out, size_t first, size_t last, Mode mode, Out seed) {
+    Out carry = seed;
+    if (mode == INCLUSIVE) {
+        #pragma omp simd reduction(inscan, +:carry)
+        for (size_t i = first; i < last; ++i) {
+            carry += static_cast<Out>(in[i]);
+            #pragma omp scan inclusive(carry)
+            out[i] = carry;
+        }
+    }
+    else {
+        #pragma omp simd reduction(inscan, +:carry)
+        for (size_t i = first; i < last; ++i) {
+            out[i] = carry;
+            #pragma omp scan exclusive(carry)
+            carry += static_cast<Out>(in[i]);
+        }
+    }
+    return carry;
+}
+
+// Adds `offset` in front of out[first, last) after an unseeded scan_range
+template <typename Out, typename Op>
+void fixup(Out* out, size_t first, size_t last, Mode mode, Op op, Out offset) {
+    if (mode == EXCLUSIVE) {
+        out[first] = offset;
+        ++first;
+    }
+    for (size_t i = first; i < last; ++i) {
+        out[i] = op(offset, out[i]);
+    }
+}
+
+template <typename In, typename Out, typename Op = std::plus<Out>>
+void blocked(const In* in, Out* out, size_t n, Mode mode = INCLUSIVE, Out init = Out(), Op op = Op()) {
+    if (n == 0) return;
+    std::vector<Out> totals(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        const int t = omp_get_thread_num(), threads = omp_get_num_threads();
+        size_t first = n * t / threads, last = n * (t + 1) / threads;
+
+        // Pass 1: local scans, the block holding element 0 already starts from init
+        if (first < last) {
+            totals[t] = scan_range(in, out, first, last, mode, op, first == 0, init);
+        }
+        #pragma omp barrier
+
+        // Scan of the block totals: offset of block t = init op totals of the blocks before it
+        if (first > 0 && first < last) {
+            bool has_offset = false;
+            Out offset{};
+            for (int b = 0; b < t; ++b) {
+                if (n * b / threads == n * (b + 1) / threads) continue;   // Empty block
+                offset = has_offset ? op(offset, totals[b]) : totals[b];
+                has_offset = true;
+            }
+
+            // Pass 2
+            fixup(out, first, last, mode, op, offset);
+        }
+    }
+}
+
+template <typename In, typename Out>
+void simd(const In* in, Out* out, size_t n, Mode mode = INCLUSIVE, Out init = Out()) {
+    if (n == 0) return;
+    std::vector<Out> totals(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        const int t = omp_get_thread_num(), threads = omp_get_num_threads();
+        size_t first = n * t / threads, last = n * (t + 1) / threads;
+
+        // + has the identity Out(), so every block scans from a seed and the fixup is a plain add
+        totals[t] = scan_range_simd(in, out, first, last, mode, t == 0 ? init : Out());
+        #pragma omp barrier
+
+        if (t > 0) {
+            Out offset = Out();
+            for (int b = 0; b < t; ++b) {
+                offset += totals[b];
+            }
+            #pragma omp simd
+            for (size_t i = first; i < last; ++i) {
+                out[i] += offset;
+            }
+        }
+    }
+}
+
+template <typename In, typename Out, typename Op = std::plus<Out>>
+void lookback(const In* in, Out* out, size_t n, Mode mode = INCLUSIVE, Out init = Out(), Op op = Op()) {
+    if (n == 0) return;
+
+    enum Flag { NOT_READY, AGGREGATE, PREFIX };
+    struct alignas(64) Tile {
+        std::atomic<int> flag{ NOT_READY };
+        Out aggregate{};   // Total of this tile, valid from AGGREGATE
+        Out prefix{};      // init op everything up to the end of this tile, valid from PREFIX
+    };
+
+    const size_t tiles = (n + TILE - 1) / TILE;
+    std::vector<Tile> state(tiles);
+    std::atomic<size_t> next(0);
+
+    #pragma omp parallel
+    {
+        for (size_t tile = next.fetch_add(1); tile < tiles; tile = next.fetch_add(1)) {
+            size_t first = tile * TILE, last = std::min(n, first + TILE);
+            Tile& self = state[tile];
+
+            Out aggregate = static_cast<Out>(in[first]);
+            for (size_t i = first + 1; i < last; ++i) {
+                aggregate = op(aggregate, static_cast<Out>(in[i]));
+            }
+
+            // Init op everything before this tile
+            Out before = init;
+            if (tile == 0) {
+                self.prefix = op(init, aggregate);
+                self.flag.store(PREFIX, std::memory_order_release);
+            }
+            else {
+                self.aggregate = aggregate;
+                self.flag.store(AGGREGATE, std::memory_order_release);
+
+                // Walk back, combining aggregates right to left, until an inclusive prefix is found
+                bool has_suffix = false;
+                Out suffix{};
+                for (size_t j = tile - 1;; --j) {
+                    int flag;
+                    int spins = 0;
+                    while ((flag = state[j].flag.load(std::memory_order_acquire)) == NOT_READY) {
+                        if (++spins % 64 == 0) std::this_thread::yield();
+                    }
+                    Out value = flag == PREFIX ? state[j].prefix : state[j].aggregate;
+                    suffix = has_suffix ? op(value, suffix) : value;
+                    has_suffix = true;
+                    if (flag == PREFIX) break;
+                }
+                before = suffix;
+                self.prefix = op(before, aggregate);
+                self.flag.store(PREFIX, std::memory_order_release);
+            }
+
+            scan_range(in, out, first, last, mode, op, true, before);
+        }
+    }
+}
+
+} // namespace scan
@@ -0,0 +1,246 @@
+#pragma once
+
+// Sparse matrices for SpMV: CSR and SELL-C-sigma.
+//
+// CSR stores the nonzeros row after row with a row pointer array. It is
+// compact, but a row is a serial dot product and short rows leave SIMD
+// lanes idle.
+//
+// SELL-C-sigma (Kreutzer et al.) cuts the rows into chunks of C rows, stores
+// each chunk column-major and pads it to its longest row, so one SIMD lane
+// works on one row. Rows are sorted by length inside windows of sigma rows
+// first, which keeps the padding small without moving rows far from their
+// neighbours in x. Both kernels work on a range of rows / chunks so the
+// caller chooses the OpenMP schedule.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "matrix.hpp"
+#include "band_matrix.hpp"
+
+namespace sparse {
+
+const int MAX_CHUNK = 64;   // Largest C, the kernel keeps one chunk of sums on the stack
+
+template <typename T>
+struct Csr {
+    int rows = 0;
+    int cols = 0;
+    std::vector<int> row_ptr;   // rows + 1 offsets into col / val
+    std::vector<int> col;
+    std::vector<T> val;
+
+    long long nnz() const { return static_cast<long long>(val.size()); }
+};
+
+template <typename T>
+struct Sell {
+    int rows = 0;
+    int cols = 0;
+    int chunk = 0;                  // C: rows per chunk, the SIMD width of the kernel
+    int sigma = 0;                  // Sorting window
+    long long nnz = 0;              // Nonzeros without padding
+    std::vector<int> chunk_ptr;     // chunks + 1 offsets into col / val
+    std::vector<int> chunk_len;     // Longest row of each chunk
+    std::vector<int> perm;          // perm[p] = original row stored at position p
+    std::vector<int> col;           // Chunk c, column j, lane r at chunk_ptr[c] + j * chunk + r
+    std::vector<T> val;
+
+    int chunks() const { return static_cast<int>(chunk_len.size()); }
+    long long stored() const { return static_cast<long long>(val.size()); }
+};
+
+// CSR of the nonzeros of a dense matrix
+template <typename T>
+Csr<T> from_dense(const matrix::Matrix<T>& a) {
+    Csr<T> csr;
+    csr.rows = a.rows();
+    csr.cols = a.cols();
+    csr.row_ptr.assign(1, 0);
+    for (int i = 0; i < a.rows(); ++i) {
+        for (int j = 0; j < a.cols(); ++j) {
+            if (a(i, j) != T()) {
+                csr.col.push_back(j);
+                csr.val.push_back(a(i, j));
+            }
+        }
+        csr.row_ptr.push_back(static_cast<int>(csr.val.size()));
+    }
+    return csr;
+}
+
+// CSR of the nonzeros inside the band; reads only the band storage
+template <typename T>
+Csr<T> from_band(const band::BandMatrix<T>& a) {
+    Csr<T> csr;
+    const int n = a.n(), k = a.k();
+    csr.rows = csr.cols = n;
+    csr.row_ptr.assign(1, 0);
+    csr.col.reserve(static_cast<size_t>(n) * (2 * k + 1));
+    csr.val.reserve(static_cast<size_t>(n) * (2 * k + 1));
+    for (int i = 0; i < n; ++i) {
+        for (int j = std::max(0, i - k); j <= std::min(n - 1, i + k); ++j) {
+            T value = a.get(i, j);
+            if (value != T()) {
+                csr.col.push_back(j);
+                csr.val.push_back(value);
+            }
+        }
+        csr.row_ptr.push_back(static_cast<int>(csr.val.size()));
+    }
+    return csr;
+}
+
+// n x n matrix with heavy-tailed (Pareto) row lengths of the given mean, rows
+// sorted longest first as in a degree-ordered graph. The long rows sit together
+// at the top, so a static split of the rows is badly unbalanced.
+template <typename T>
+Csr<T> irregular(int n, double mean_nnz, unsigned seed, double alpha = 1.5) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::uniform_int_distribution<int> column(0, n - 1);
+    std::uniform_int_distribution<int> value(1, 100);
+
+    // Pareto with shape alpha and the requested mean: x_min = mean * (alpha - 1) / alpha
+    const double x_min = mean_nnz * (alpha - 1.0) / alpha;
+    std::vector<int> lengths(n);
+    for (int& length : lengths) {
+        double x = x_min / std::pow(1.0 - uniform(gen), 1.0 / alpha);
+        length = static_cast<int>(std::min<double>(std::max(1.0, x), n));
+    }
+    std::sort(lengths.begin(), lengths.end(), std::greater<int>());
+
+    Csr<T> csr;
+    csr.rows = csr.cols = n;
+    csr.row_ptr.assign(1, 0);
+    std::vector<int> row;
+    for (int i = 0; i < n; ++i) {
+        row.resize(lengths[i]);
+        for (int& j : row) j = column(gen);
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+        for (int j : row) {
+            csr.col.push_back(j);
+            csr.val.push_back(static_cast<T>(value(gen)));
+        }
+        csr.row_ptr.push_back(static_cast<int>(csr.val.size()));
+    }
+    return csr;
+}
+
+template <typename T>
+Sell<T> to_sell(const Csr<T>& csr, int chunk, int sigma) {
+    Sell<T> sell;
+    sell.rows = csr.rows;
+    sell.cols = csr.cols;
+    chunk = std::max(1, std::min(chunk, MAX_CHUNK));
+    sell.chunk = chunk;
+    sell.sigma = std::max(sigma, 1);
+    sell.nnz = csr.nnz();
+
+    auto length = [&](int i) { return csr.row_ptr[i + 1] - csr.row_ptr[i]; };
+
+    // Sort by decreasing length inside every window of sigma rows
+    sell.perm.resize(csr.rows);
+    std::iota(sell.perm.begin(), sell.perm.end(), 0);
+    for (int w = 0; w < csr.rows; w += sell.sigma) {
+        auto first = sell.perm.begin() + w;
+        auto last = sell.perm.begin() + std::min(csr.rows, w + sell.sigma);
+        std::stable_sort(first, last, [&](int a, int b) { return length(a) > length(b); });
+    }
+
+    int chunks = (csr.rows + chunk - 1) / chunk;
+    sell.chunk_len.assign(chunks, 0);
+    sell.chunk_ptr.assign(chunks + 1, 0);
+    for (int c = 0; c < chunks; ++c) {
+        for (int r = 0; r < chunk && c * chunk + r < csr.rows; ++r) {
+            sell.chunk_len[c] = std::max(sell.chunk_len[c], length(sell.perm[c * chunk + r]));
+        }
+        sell.chunk_ptr[c + 1] = sell.chunk_ptr[c] + sell.chunk_len[c] * chunk;
+    }
+
+    // Padding has value 0 and repeats a valid column so the kernel needs no branch
+    sell.col.assign(sell.chunk_ptr[chunks], 0);
+    sell.val.assign(sell.chunk_ptr[chunks], T());
+    for (int c = 0; c < chunks; ++c) {
+        for (int r = 0; r < chunk && c * chunk + r < csr.rows; ++r) {
+            int i = sell.perm[c * chunk + r];
+            int begin = csr.row_ptr[i], len = length(i);
+            for (int j = 0; j < sell.chunk_len[c]; ++j) {
+                size_t at = static_cast<size_t>(sell.chunk_ptr[c]) + static_cast<size_t>(j) * chunk + r;
+                if (j < len) {
+                    sell.col[at] = csr.col[begin + j];
+                    sell.val[at] = csr.val[begin + j];
+                }
+                else if (len > 0) {
+                    sell.col[at] = csr.col[begin + len - 1];
+                }
+            }
+        }
+    }
+    return sell;
+}
+
+// y[i] = sum_j a(i, j) * x[j] for rows i in [first, last)
+template <typename T, typename U>
+void spmv(const Csr<T>& a, const U* x, U* y, int first, int last) {
+    for (int i = first; i < last; ++i) {
+        U sum = U();
+        #pragma omp simd reduction(+:sum)
+        for (int p = a.row_ptr[i]; p < a.row_ptr[i + 1]; ++p) {
+            sum += static_cast<U>(a.val[p]) * x[a.col[p]];
+        }
+        y[i] = sum;
+    }
+}
+
+// The same for the rows of chunks [first, last); lanes run across the rows of a chunk
+template <typename T, typename U>
+void spmv(const Sell<T>& a, const U* x, U* y, int first, int last) {
+    const int C = a.chunk;
+    U sums[MAX_CHUNK];
+    for (int c = first; c < last; ++c) {
+        std::fill(sums, sums + C, U());
+        const int* col = a.col.data() + a.chunk_ptr[c];
+        const T* val = a.val.data() + a.chunk_ptr[c];
+        for (int j = 0; j < a.chunk_len[c]; ++j) {
+            #pragma omp simd
+            for (int r = 0; r < C; ++r) {
+                sums[r] += static_cast<U>(val[j * C + r]) * x[col[j * C + r]];
+            }
+        }
+        int rows = std::min(C, a.rows - c * C);
+        for (int r = 0; r < rows; ++r) {
+            y[a.perm[c * C + r]] = sums[r];
+        }
+    }
+}
+
+// Minimum bytes one SpMV moves: the matrix arrays once, x and y once each
+template <typename T, typename U = double>
+double traffic_bytes(const Csr<T>& a) {
+    return static_cast<double>(a.nnz()) * (sizeof(T) + sizeof(int))
+        + static_cast<double>(a.rows + 1) * sizeof(int)
+        + static_cast<double>(a.cols + a.rows) * sizeof(U);
+}
+
+template <typename T, typename U = double>
+double traffic_bytes(const Sell<T>& a) {
+    return static_cast<double>(a.stored()) * (sizeof(T) + sizeof(int))
+        + static_cast<double>(a.chunks()) * 2 * sizeof(int)
+        + static_cast<double>(a.rows) * sizeof(int)
+        + static_cast<double>(a.cols + a.rows) * sizeof(U);
+}
+
+// Two floating point operations per nonzero
+inline double gflops(long long nnz, double seconds) {
+    return seconds > 0 ? 2.0 * nnz / seconds / 1e9 : 0.0;
+}
+
+} // namespace sparse
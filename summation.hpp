@@ -0,0 +1,158 @@
+#pragma once
+
+// Parallel summation strategies that do not contend on one shared variable.
+//
+// Each OpenMP thread sums a contiguous block, so all of them touch their own
+// memory until the partial sums are combined. They differ in where the
+// running sum lives and in how the partials are combined:
+//   padded         running sum in a per-thread slot of its own cache line
+//   false_sharing  the same with unpadded slots, eight to a cache line (negative control)
+//   tree           register sum, then log2(threads) pairwise combine rounds
+//   atomic         register sum, then one relaxed fetch_add per thread on an atomic<double>
+//   simd           register sums in ACCUMULATORS independent lanes, so the
+//                  loop is vectorized and not bound by the latency of one add chain
+// padded and false_sharing update their slot through a volatile pointer on
+// every element. Otherwise the compiler keeps the sum in a register and the
+// cache-line effect being measured disappears.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <omp.h>
+
+namespace summation {
+
+const int CACHE_LINE = 64;
+const int ACCUMULATORS = 16;
+
+struct alignas(CACHE_LINE) Padded {
+    double value = 0.0;
+};
+
+// Block [first, last) of n elements for thread t of threads
+inline void block(size_t n, int t, int threads, size_t& first, size_t& last) {
+    first = n * t / threads;
+    last = n * (t + 1) / threads;
+}
+
+template <typename T>
+double padded(const T* data, size_t n) {
+    std::vector<Padded> partial(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        size_t first, last;
+        block(n, omp_get_thread_num(), omp_get_num_threads(), first, last);
+        volatile double* sum = &partial[omp_get_thread_num()].value;
+        for (size_t i = first; i < last; ++i) {
+            *sum = *sum + data[i];
+        }
+    }
+
+    double sum = 0.0;
+    for (const Padded& p : partial) sum += p.value;
+    return sum;
+}
+
+template <typename T>
+double false_sharing(const T* data, size_t n) {
+    std::vector<double> partial(omp_get_max_threads(), 0.0);
+
+    #pragma omp parallel
+    {
+        size_t first, last;
+        block(n, omp_get_thread_num(), omp_get_num_threads(), first, last);
+        volatile double* sum = &partial[omp_get_thread_num()];
+        for (size_t i = first; i < last; ++i) {
+            *sum = *sum + data[i];
+        }
+    }
+
+    double sum = 0.0;
+    for (double p : partial) sum += p;
+    return sum;
+}
+
+template <typename T>
+double tree(const T* data, size_t n) {
+    std::vector<Padded> partial(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        const int t = omp_get_thread_num(), threads = omp_get_num_threads();
+        size_t first, last;
+        block(n, t, threads, first, last);
+        double sum = 0.0;
+        for (size_t i = first; i < last; ++i) {
+            sum += data[i];
+        }
+        partial[t].value = sum;
+
+        // Round r adds the partial 2^r slots to the right into every multiple of 2^(r+1)
+        for (int stride = 1; stride < threads; stride *= 2) {
+            #pragma omp barrier
+            if (t % (2 * stride) == 0 && t + stride < threads) {
+                partial[t].value += partial[t + stride].value;
+            }
+        }
+    }
+
+    return partial[0].value;
+}
+
+template <typename T>
+double atomic(const T* data, size_t n) {
+    std::atomic<double> total(0.0);
+
+    #pragma omp parallel
+    {
+        size_t first, last;
+        block(n, omp_get_thread_num(), omp_get_num_threads(), first, last);
+        double sum = 0.0;
+        for (size_t i = first; i < last; ++i) {
+            sum += data[i];
+        }
+#if defined(__cpp_lib_atomic_float)
+        total.fetch_add(sum, std::memory_order_relaxed);
+#else
+        // atomic<double>::fetch_add is C++20; the same as a CAS loop before it
+        double expected = total.load(std::memory_order_relaxed);
+        while (!total.compare_exchange_weak(expected, expected + sum, std::memory_order_relaxed)) {
+        }
+#endif
+    }
+
+    return total.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+double simd(const T* data, size_t n) {
+    double sum = 0.0;
+
+    #pragma omp parallel reduction(+:sum)
+    {
+        size_t first, last;
+        block(n, omp_get_thread_num(), omp_get_num_threads(), first, last);
+
+        double lanes[ACCUMULATORS] = {};
+        size_t i = first;
+        for (; i + ACCUMULATORS <= last; i += ACCUMULATORS) {
+            #pragma omp simd
+            for (int j = 0; j < ACCUMULATORS; ++j) {
+                lanes[j] += data[i + j];
+            }
+        }
+        for (; i < last; ++i) {
+            lanes[0] += data[i];
+        }
+        for (int j = 0; j < ACCUMULATORS; ++j) {
+            sum += lanes[j];
+        }
+    }
+
+    return sum;
+}
+
+} // namespace summation
@@ -0,0 +1,200 @@
+#pragma once
+
+// Work-stealing parallel for on top of an OpenMP team.
+//
+// Every thread owns a Chase-Lev deque of iteration ranges (the C11 version of
+// Le, Pop, Cohen and Zappa Nardelli). The owner pushes and pops at the bottom
+// without a lock; thieves take the oldest, and therefore largest, range from
+// the top with a single CAS. Only the last element is contended.
+//
+// Thread t starts with block t of a static partition. To run a range it keeps
+// splitting it in half, pushes the upper half and goes on with the lower half
+// until at most `grain` iterations are left. Those are executed in place.
+// A range a thief takes is split the same way in its own deque. Balanced loops
+// therefore behave like schedule(static), and only the unbalanced part of a
+// loop is redistributed. Every deque holds at most log2(n / grain) + 1 ranges,
+// so a fixed ring buffer is enough.
+//
+// Every thread reports its busy time (executing iterations), idle time (looking
+// for work), and successful and failed steals, so load imbalance is measured.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <omp.h>
+
+#include "rng.hpp"
+
+namespace work_stealing {
+
+struct Range {
+    long long begin = 0;
+    long long end = 0;
+
+    long long size() const { return end - begin; }
+};
+
+class Deque {
+public:
+    static const long long CAPACITY = 64;
+
+    // Owner only. Returns false if the deque is full.
+    bool push(Range r) {
+        long long b = bottom_.load(std::memory_order_relaxed);
+        long long t = top_.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) {
+            return false;
+        }
+        slots_[b % CAPACITY].begin.store(r.begin, std::memory_order_relaxed);
+        slots_[b % CAPACITY].end.store(r.end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only. Takes the newest range.
+    bool pop(Range& r) {
+        long long b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        r = load(b);
+        if (t == b) {
+            // Last range: race the thieves for it
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread. Takes the oldest range; fails if the deque is empty or another thread won.
+    bool steal(Range& r) {
+        long long t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        r = load(t);
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    // Both halves are atomic so a thief that reads a slot while it is reused
+    // has no data race; its CAS on top then fails and the value is dropped.
+    struct Slot {
+        std::atomic<long long> begin{ 0 };
+        std::atomic<long long> end{ 0 };
+    };
+
+    Range load(long long index) const {
+        const Slot& s = slots_[index % CAPACITY];
+        return Range{ s.begin.load(std::memory_order_relaxed), s.end.load(std::memory_order_relaxed) };
+    }
+
+    alignas(64) std::atomic<long long> top_{ 0 };
+    alignas(64) std::atomic<long long> bottom_{ 0 };
+    alignas(64) Slot slots_[CAPACITY];
+};
+
+// What one thread did during one parallel_for
+struct ThreadStats {
+    double busy = 0.0;             // Seconds spent executing iterations
+    double idle = 0.0;             // Seconds from the start of the loop to its end spent on anything else
+    long long iterations = 0;
+    long long ranges = 0;          // Ranges executed without further splitting
+    long long steals = 0;          // Successful steals
+    long long failed_steals = 0;   // Steal attempts on an empty deque or lost to another thread
+};
+
+// Calls body(i) for every i in [first, last) on `threads` OpenMP threads.
+// Ranges of at most `grain` iterations are not split further.
+template <typename Body>
+std::vector<ThreadStats> parallel_for(long long first, long long last, long long grain, int threads, Body body) {
+    using clock = std::chrono::steady_clock;
+
+    grain = std::max(grain, 1LL);
+    threads = std::max(threads, 1);
+    std::vector<Deque> deques(threads);
+    std::vector<ThreadStats> stats(threads);
+    std::atomic<long long> remaining(last - first);
+
+    #pragma omp parallel num_threads(threads)
+    {
+        const int me = omp_get_thread_num();
+        const int team = omp_get_num_threads();
+        Deque& own = deques[me];
+        ThreadStats local;
+        rng::Xoshiro256ss victims(0x5ea1 + me);
+        const clock::time_point start = clock::now();
+
+        // Runs r, pushing upper halves until at most grain iterations are left
+        auto run = [&](Range r) {
+            while (r.size() > grain) {
+                long long middle = r.begin + r.size() / 2;
+                if (!own.push(Range{ middle, r.end })) break;
+                r.end = middle;
+            }
+            clock::time_point t0 = clock::now();
+            for (long long i = r.begin; i < r.end; ++i) {
+                body(i);
+            }
+            local.busy += std::chrono::duration<double>(clock::now() - t0).count();
+            local.iterations += r.size();
+            local.ranges += 1;
+            remaining.fetch_sub(r.size(), std::memory_order_acq_rel);
+        };
+
+        // Static initial partition over the threads actually in the team
+        long long n = last - first;
+        Range block{ first + n * me / team, first + n * (me + 1) / team };
+        if (block.size() > 0) {
+            run(block);
+        }
+
+        Range r;
+        int misses = 0;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (own.pop(r)) {
+                run(r);
+                continue;
+            }
+            if (team == 1) {
+                continue;
+            }
+            int victim = static_cast<int>(victims() % (team - 1));
+            if (victim >= me) ++victim;
+            if (deques[victim].steal(r)) {
+                local.steals += 1;
+                misses = 0;
+                run(r);
+            }
+            else {
+                local.failed_steals += 1;
+                // Give the core away when nothing is found, threads may outnumber cores
+                if (++misses >= team) {
+                    misses = 0;
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        #pragma omp barrier
+        double total = std::chrono::duration<double>(clock::now() - start).count();
+        local.idle = total - local.busy;
+        stats[me] = local;
+    }
+
+    return stats;
+}
+
+} // namespace work_stealing